@@ -0,0 +1,197 @@
+#define TSS_NO_MAIN
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include "rrSetsIC.cpp"
+#include "localSearchIC.cpp"
+#include "metaheuristicIC.cpp"
+#include "localSearchLT.cpp"
+#include "metaheursticLT.cpp"
+using namespace std;
+using namespace std::chrono;
+
+// Batch driver: runs a sweep of jobs on one graph, which is loaded once and shared read-only by all of them
+//
+//     ./batch jobs.txt < instances/graph_jazz.dimacs > results.jsonl
+//
+// Every line of the job file is a job: the algorithm (greedy, localSearch or SA), the model (IC or LT) and its
+// parameters as name=value, e.g.
+//
+//     greedy IC p=0.1 nMonteCarlo=100 optimality=0.9
+//     SA LT r=0.5 maxIter=20000 alpha=0.995
+//
+// '#' starts a comment. The parameters left out take the values of the main of the single program (greedyIC.cpp,
+// localSearchLT.cpp, ...), and localSearch and SA start, as there, from the greedy solution
+// The jobs run concurrently, one per thread, so the parallel loops inside a job run serially. Every job numbers its
+// Monte Carlo calls from 0 with the seed of the batch (TSS_SEED), so an IC job gives the same result as the single
+// program run with that seed, whatever the other jobs. A JSON line with the parameters, the seeds and the timings is
+// written to the standard output as soon as every job finishes
+
+struct Job {
+    int index;
+    string algorithm, model;
+    map<string, double> params;
+    // Parameters read by the job, with their values (given or default)
+    map<string, double> used;
+
+    double param(const string& name, double value) {
+        auto it = params.find(name);
+        if (it != params.end()) value = it->second;
+        used[name] = value;
+        return value;
+    }
+};
+
+vector<Job> readJobs(const string& path) {
+    ifstream in(path);
+    if (not in) {
+        cerr << "Cannot open the job file " << path << endl;
+        exit(1);
+    }
+    vector<Job> jobs;
+    string line;
+    for (int lineNumber = 1; getline(in, line); ++lineNumber) {
+        line = line.substr(0, line.find('#'));
+        istringstream words(line);
+        Job job;
+        if (not (words >> job.algorithm)) continue;
+        job.index = jobs.size();
+        words >> job.model;
+        bool valid = (job.algorithm == "greedy" or job.algorithm == "localSearch" or job.algorithm == "SA") and
+                     (job.model == "IC" or job.model == "LT");
+        string word;
+        while (valid and words >> word) {
+            size_t eq = word.find('=');
+            char* end = nullptr;
+            if (eq != string::npos) job.params[word.substr(0, eq)] = strtod(word.c_str() + eq + 1, &end);
+            valid = eq != string::npos and end != word.c_str() + eq + 1 and *end == '\0';
+        }
+        if (not valid) {
+            cerr << path << ":" << lineNumber << ": expected greedy|localSearch|SA IC|LT name=value..." << endl;
+            exit(1);
+        }
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+// Seconds since start
+double secondsSince(steady_clock::time_point start) {
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+// JSON line with the result of a job, its initial (greedy) solution included for localSearch and SA
+string jobResult(const Graph& G, const Job& job, uint64_t seed, const SeedSet* initial, double initialTime,
+                 const SeedSet& S, double time) {
+    ostringstream out;
+    out << "{\"job\": " << job.index << ", \"algorithm\": \"" << job.algorithm << "\", \"model\": \"" << job.model
+        << "\", \"params\": {";
+    bool first = true;
+    for (const auto& param : job.used) {
+        out << (first ? "" : ", ") << "\"" << param.first << "\": " << param.second;
+        first = false;
+    }
+    out << "}, \"seed\": " << seed << ", \"nodes\": " << G.numNodes << ", \"edges\": " << G.numEdges;
+    if (initial != nullptr) out << ", \"initialSeeds\": " << initial->size() << ", \"initialTime\": " << initialTime;
+    out << ", \"seeds\": " << S.size() << ", \"time\": " << time << ", \"seedNodes\": [";
+    for (size_t i = 0; i < S.size(); ++i) out << (i > 0 ? ", " : "") << G.originalId[S[i]];
+    out << "]}";
+    return out.str();
+}
+
+string runICJob(const Graph& G, Job& job, uint64_t seed) {
+    // Replay the calls of the single program from the start
+    numMonteCarloCalls = 0;
+    bool greedy = job.algorithm == "greedy";
+    double p = job.param("p", 0.5);
+    int nMonteCarlo = job.param("nMonteCarlo", greedy ? 1 : job.algorithm == "SA" ? 10 : 100);
+    double optimality = job.param("optimality", greedy ? 0.99 : 1);
+
+    auto start = steady_clock::now();
+    SeedSet S = greedy and job.param("reverseSampling", 0) ? rrMinInfluenceSet(G, p, optimality)
+                                                            : greedyMinInfluenceSet(G, p, nMonteCarlo, optimality);
+    double initialTime = secondsSince(start);
+    if (greedy) return jobResult(G, job, seed, nullptr, 0, S, initialTime);
+
+    SeedSet initial = S;
+    start = steady_clock::now();
+    if (job.algorithm == "localSearch") {
+        if (job.param("bestImprovement", 1)) bestImprovementLocalSearch(G, p, S, nMonteCarlo, optimality, job.param("maxSwaps", 100));
+        else localSearch(G, p, S, nMonteCarlo, optimality, job.param("cacheSize", 1 << 16), job.param("sequentialTests", 1));
+    }
+    else {
+        int maxIter = job.param("maxIter", 1000);
+        double T = job.param("T", 100);
+        double alpha = job.param("alpha", 0.99);
+        int chains = job.param("chains", 1);
+        int exchangeEvery = job.param("exchangeEvery", 10);
+        size_t cacheSize = job.param("cacheSize", 1 << 16);
+        S = simulatedAnnealing(G, p, S, nMonteCarlo, optimality, maxIter, T, alpha, chains, exchangeEvery, cacheSize);
+    }
+    return jobResult(G, job, seed, &initial, initialTime, S, secondsSince(start));
+}
+
+string runLTJob(const Graph& graph, Job& job, uint64_t seed) {
+    // Every job keeps its diffusion state in its own copy of the graph, which shares the arrays
+    LTGraph G(graph);
+    bool greedy = job.algorithm == "greedy";
+    double r = job.param("r", 0.5);
+
+    auto start = steady_clock::now();
+    SeedSet S = greedyMinInfluenceSet(G, r, job.param("bySpread", greedy) ? BY_SPREAD : BY_DEGREE);
+    double initialTime = secondsSince(start);
+    if (greedy) return jobResult(G, job, seed, nullptr, 0, S, initialTime);
+
+    SeedSet initial = S;
+    start = steady_clock::now();
+    if (job.algorithm == "localSearch") localSearch(G, r, S);
+    else {
+        int maxIter = job.param("maxIter", 15000);
+        double T = job.param("T", 100);
+        double alpha = job.param("alpha", 0.99);
+        int chains = job.param("chains", 1);
+        int exchangeEvery = job.param("exchangeEvery", 100);
+        size_t cacheSize = job.param("cacheSize", 1 << 16);
+        // The chains of every job get their own seed
+        S = simulatedAnnealing(G, r, S, maxIter, T, alpha, chains, exchangeEvery, cacheSize, splitMix64(seed ^ job.index));
+    }
+    return jobResult(G, job, seed, &initial, initialTime, S, secondsSince(start));
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        cerr << "Usage: " << argv[0] << " jobs.txt < graph.dimacs" << endl;
+        return 1;
+    }
+    vector<Job> jobs = readJobs(argv[1]);
+
+    // Generate random seed for proper random values (set TSS_SEED to replay a run)
+    uint64_t seed = chooseSeed();
+    seedMonteCarlo(seed);
+
+    // Declare and read the graph G = (V, E) with the ids of the file. RCM lays neighbourhoods out contiguously in
+    // memory, but ties between nodes are broken on their ids, so it could change the seeds found
+    Graph G = readGraph(NATURAL);
+
+    // Set the sampler of the IC simulations: BIT_PARALLEL and COIN_FLIP for high probabilities, GEOMETRIC for low ones
+    icSampler = BIT_PARALLEL;
+
+    cerr << "Batch: " << jobs.size() << " jobs on " << threadPool().numThreads() << " threads" << endl;
+    auto start = steady_clock::now();
+    mutex output;
+    parallelFor(jobs.size(), [&](int i) {
+        Job& job = jobs[i];
+        string result = job.model == "IC" ? runICJob(G, job, seed) : runLTJob(G, job, seed);
+        for (const auto& param : job.params) {
+            if (not job.used.count(param.first)) cerr << "Job " << i << ": unused parameter " << param.first << endl;
+        }
+        lock_guard<mutex> lock(output);
+        cout << result << endl;
+    });
+    cerr << "Batch: " << jobs.size() << " jobs in " << secondsSince(start) << " s" << endl;
+}
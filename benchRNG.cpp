@@ -0,0 +1,39 @@
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include "rng.cpp"
+using namespace std;
+using namespace std::chrono;
+
+// Microbenchmark of the random number generators: time to draw n uniforms in [0, 1) and their mean
+template <class F>
+void bench(const string& name, int n, F next) {
+    auto start = high_resolution_clock::now();
+    double sum = 0;
+    for (int i = 0; i < n; ++i) sum += next();
+    double seconds = duration<double>(high_resolution_clock::now() - start).count();
+    cout << name << ": " << n / seconds / 1e6 << " M numbers/s (" << 1e9 * seconds / n << " ns/number), mean " << sum / n << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 100000000;
+    uint64_t seed = 12345;
+
+    srand(seed);
+    bench("rand() / RAND_MAX", n, [] { return (double) rand() / RAND_MAX; });
+
+    MersenneTwister mt(seed);
+    bench("MersenneTwister  ", n, [&] { return mt.uniform(); });
+
+    Philox philox(seed);
+    bench("Philox           ", n, [&] { return philox.uniform(); });
+
+    // Short streams, as in a Monte Carlo simulation that only draws a few numbers
+    int streams = n / 100;
+    Philox seeker(seed);
+    bench("Philox, seek/100 ", streams * 100, [&, k = 0]() mutable {
+        if (k % 100 == 0) seeker.seek(k / 100);
+        ++k;
+        return seeker.uniform();
+    });
+}
@@ -0,0 +1,393 @@
+#define TSS_NO_MAIN
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "localSearchIC.cpp"
+#include "metaheuristicIC.cpp"
+#include "localSearchLT.cpp"
+#include "metaheursticLT.cpp"
+using namespace std;
+using namespace std::chrono;
+
+// Benchmark suite: the cascade kernels (difusioIC, simulateLT, monteCarlo) and the search algorithms of both models
+// on every graph of instances/, with fixed seeds and parameters, so that two runs on the same machine do the same work
+//
+//     ./benchmark [--save] [graph...]
+//
+// The kernels run for at least kernelSeconds and report the cascades/s and edges/s, the edges scanned per second
+// (those of the influenced nodes), of their fastest batch; the searches report their time, the best of the runs in
+// kernelSeconds if they are fast, and the seeds they find. The load of the graph is not timed. Every benchmark also
+// reports its peak resident set size, reset before it starts
+// The results are compared with the baseline in benchmark.json: a throughput or a time worse than the baseline by
+// more than the tolerance, a larger peak RSS or more seeds are flagged as regressions, and the exit status is 1 if
+// there is any. --save writes the results as the new baseline instead. Only the graphs given are run, if any
+// Everything runs on the default threads (TSS_THREADS, or all the cores), whose number is saved with every result.
+// Times and throughputs are only compared with a baseline run on as many threads, since they scale with them; the
+// seeds found do not depend on the threads and are always compared. The baseline in the repository was recorded on
+// a single core, so a run on a larger machine has to be saved first to get a timing baseline for it
+
+struct BenchResult {
+    string graph, name;
+    int threads;
+    double seconds;
+    // Cascades run (-1 for the searches) and edges they scanned
+    long long cascades;
+    double edges;
+    // Seeds found (-1 for the kernels)
+    int seeds;
+    // Peak resident set size, in kB
+    long long peakRSS;
+
+    double cascadesPerSecond() const {
+        return cascades / seconds;
+    }
+
+    double edgesPerSecond() const {
+        return edges / seconds;
+    }
+};
+
+// Reset the peak resident set size of the process, where Linux allows it (otherwise the peak is the one of the process)
+void resetPeakRSS() {
+    ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+}
+
+long long peakRSS() {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return atoll(line.c_str() + 6);
+    }
+    return -1;
+}
+
+double secondsSince(steady_clock::time_point start) {
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+// Minimum time of every kernel
+double kernelSeconds = 0.5;
+
+// Mean number of edges scanned by the cascades of cascade(), which leaves its influenced nodes marked in ws, over
+// a sample of them (not timed, since the degrees are added over all the nodes)
+template <class F>
+double edgesPerCascade(const Graph& G, const SimulationWorkspace& ws, F cascade, int samples = 16) {
+    double edges = 0;
+    for (int i = 0; i < samples; ++i) {
+        cascade();
+        for (int v = 0; v < G.numNodes; ++v) if (ws.visited(v)) edges += G.degree(v);
+    }
+    return edges / samples;
+}
+
+// Time a kernel: runBatch(k) runs k calls and returns the cascades they ran. The batches double until one takes a
+// tenth of kernelSeconds, and are then repeated until kernelSeconds have gone by; the fastest batch is kept, which
+// filters out the interruptions of a busy machine
+template <class F>
+BenchResult benchKernel(const string& graph, const string& name, double edgesPerCascade, F runBatch) {
+    resetPeakRSS();
+    int k = 1;
+    long long cascades = 0;
+    double seconds = 0;
+    auto first = steady_clock::now();
+    while (cascades == 0 or secondsSince(first) < kernelSeconds) {
+        auto start = steady_clock::now();
+        long long c = runBatch(k);
+        double s = secondsSince(start);
+        if (s < kernelSeconds / 10) k *= 2;
+        else if (cascades == 0 or c / s > cascades / seconds) {
+            cascades = c;
+            seconds = s;
+        }
+    }
+    return {graph, name, threadPool().numThreads(), seconds, cascades, cascades * edgesPerCascade, -1, peakRSS()};
+}
+
+// Time a search: search() returns the seeds it found. The fast ones are repeated until they have taken
+// kernelSeconds, and the best time is kept
+template <class F>
+BenchResult benchSearch(const string& graph, const string& name, F search) {
+    resetPeakRSS();
+    auto first = steady_clock::now();
+    double seconds = 1e300;
+    int seeds = -1;
+    while (seeds == -1 or secondsSince(first) < kernelSeconds) {
+        auto start = steady_clock::now();
+        seeds = search().size();
+        seconds = min(seconds, secondsSince(start));
+    }
+    return {graph, name, threadPool().numThreads(), seconds, -1, 0, seeds, peakRSS()};
+}
+
+// Graphs of dir (the .dimacs files), from the smallest to the largest
+vector<string> instanceFiles(const string& dir) {
+    vector<pair<long long, string> > files;
+    DIR* d = opendir(dir.c_str());
+    if (d == nullptr) {
+        cerr << "Can not open " << dir << endl;
+        exit(1);
+    }
+    while (dirent* entry = readdir(d)) {
+        string name = entry->d_name;
+        if (name.size() <= 7 or name.compare(name.size() - 7, 7, ".dimacs") != 0) continue;
+        struct stat st;
+        stat((dir + "/" + name).c_str(), &st);
+        files.push_back(make_pair((long long) st.st_size, name));
+    }
+    closedir(d);
+    sort(files.begin(), files.end());
+    vector<string> names;
+    for (const auto& f : files) names.push_back(f.second);
+    return names;
+}
+
+void writeResults(const string& path, const vector<BenchResult>& results) {
+    ofstream out(path);
+    out << setprecision(10) << "[" << endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "  {\"graph\": \"" << r.graph << "\", \"name\": \"" << r.name << "\", \"threads\": " << r.threads
+            << ", \"seconds\": " << r.seconds << ", \"cascades\": " << r.cascades << ", \"edges\": " << r.edges
+            << ", \"seeds\": " << r.seeds << ", \"peakRSS\": " << r.peakRSS << "}" << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    out << "]" << endl;
+}
+
+// Value of a field in a line written by writeResults
+string jsonField(const string& line, const string& key) {
+    size_t i = line.find("\"" + key + "\": ");
+    if (i == string::npos) return "";
+    i += key.size() + 4;
+    if (line[i] == '"') return line.substr(i + 1, line.find('"', i + 1) - i - 1);
+    return line.substr(i, line.find_first_of(",}", i) - i);
+}
+
+vector<BenchResult> readResults(const string& path) {
+    ifstream in(path);
+    vector<BenchResult> results;
+    string line;
+    while (getline(in, line)) {
+        if (line.find("\"graph\"") == string::npos) continue;
+        results.push_back({jsonField(line, "graph"), jsonField(line, "name"), atoi(jsonField(line, "threads").c_str()),
+                           atof(jsonField(line, "seconds").c_str()), atoll(jsonField(line, "cascades").c_str()),
+                           atof(jsonField(line, "edges").c_str()), atoi(jsonField(line, "seeds").c_str()),
+                           atoll(jsonField(line, "peakRSS").c_str())});
+    }
+    return results;
+}
+
+// Compare the results with the baseline, printing every change beyond the tolerance; returns the number of regressions
+// Times below minSeconds are too noisy to be compared
+int compareResults(const vector<BenchResult>& results, const vector<BenchResult>& baseline, double tolerance, double minSeconds) {
+    int regressions = 0;
+    for (const BenchResult& r : results) {
+        auto b = find_if(baseline.begin(), baseline.end(), [&](const BenchResult& x) { return x.graph == r.graph and x.name == r.name; });
+        string where = r.graph + " " + r.name + ": ";
+        if (b == baseline.end()) {
+            cout << where << "not in the baseline" << endl;
+            continue;
+        }
+        // Times on other threads are not comparable
+        bool timed = b->threads == r.threads;
+        if (not timed) cout << where << "baseline run with " << b->threads << " threads, times not compared" << endl;
+        vector<string> worse, better;
+        auto change = [](double now, double before) {
+            ostringstream s;
+            s << showpos << fixed << setprecision(1) << 100 * (now / before - 1) << "%";
+            return s.str();
+        };
+        if (timed and r.cascades >= 0 and b->cascades > 0) {
+            double now = r.cascadesPerSecond(), before = b->cascadesPerSecond();
+            if (now < before * (1 - tolerance)) worse.push_back("cascades/s " + change(now, before));
+            else if (now > before * (1 + tolerance)) better.push_back("cascades/s " + change(now, before));
+        }
+        if (r.seeds >= 0) {
+            if (r.seeds > b->seeds) worse.push_back("seeds " + to_string(b->seeds) + " -> " + to_string(r.seeds));
+            else if (r.seeds < b->seeds) better.push_back("seeds " + to_string(b->seeds) + " -> " + to_string(r.seeds));
+            if (timed and max(r.seconds, b->seconds) >= minSeconds) {
+                if (r.seconds > b->seconds * (1 + tolerance)) worse.push_back("time " + change(r.seconds, b->seconds));
+                else if (r.seconds < b->seconds * (1 - tolerance)) better.push_back("time " + change(r.seconds, b->seconds));
+            }
+        }
+        if (r.peakRSS > b->peakRSS * (1 + tolerance) and r.peakRSS - b->peakRSS > 1024) {
+            worse.push_back("peak RSS " + change(r.peakRSS, b->peakRSS));
+        }
+        for (const string& s : worse) cout << where << "REGRESSION " << s << endl;
+        for (const string& s : better) cout << where << "improved " << s << endl;
+        if (not worse.empty()) ++regressions;
+    }
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    bool save = false;
+    vector<string> only;
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--save") save = true;
+        else only.push_back(argv[i]);
+    }
+    string instances = "instances";
+    string baselineFile = "benchmark.json";
+
+    // Fixed seed of every run, for the Monte Carlo simulations, the seed sets of the kernels and simulated annealing
+    uint64_t seed = 12345;
+    srand(seed);
+
+    // Parameters of the models and of the algorithms (changing them invalidates the baseline)
+    double p = 0.1;
+    double r = 0.5;
+    int nMonteCarlo = 640;
+    // Seeds of the cascades of the IC kernels, drawn at random (simulateLT starts from the greedy solution, since a
+    // few random seeds rarely influence anything under the LT model)
+    int kernelSeeds = 10;
+    // The IC searches evaluate the seed sets on numWorlds condensed live-edge worlds: with fresh Monte Carlo
+    // simulations a greedy run takes minutes on the larger graphs
+    int numWorlds = 32;
+    double optimality = 0.9;
+    int maxSwaps = 100;
+    int maxIterIC = 200, maxIterLT = 1000;
+    double T = 100, alpha = 0.99;
+    size_t cacheSize = 1 << 16;
+    // The IC searches also run with fresh Monte Carlo simulations, as their programs do by default: CELF++ and
+    // singletonSpreads, the best improvement swaps, the sequential tests and the fitness caches. They use few
+    // simulations, on a sparser p and a lower optimality, since at p and optimality the greedy needs thousands of
+    // seeds and minutes on socfb-Mich67, or a single seed that leaves nothing to the local searches
+    int nMC = 20;
+    double pMC = 0.01, optimalityMC = 0.3;
+    vector<string> monteCarloGraphs = {"graph_jazz", "socfb-Mich67"};
+
+    // Changes within the tolerance are noise, and so are times below minSeconds
+    double tolerance = 0.25;
+    double minSeconds = 0.05;
+
+    vector<BenchResult> results;
+    cout << left << setw(20) << "graph" << setw(24) << "benchmark" << right << setw(10) << "seconds" << setw(14)
+         << "cascades/s" << setw(14) << "edges/s" << setw(8) << "seeds" << setw(14) << "peak RSS (MB)" << endl;
+    auto print = [&](const BenchResult& b) {
+        results.push_back(b);
+        cout << left << setw(20) << b.graph << setw(24) << b.name << right << fixed << setprecision(3) << setw(10) << b.seconds
+             << defaultfloat << setprecision(4) << setw(14);
+        if (b.cascades >= 0) cout << b.cascadesPerSecond() << setw(14) << b.edgesPerSecond();
+        else cout << "-" << setw(14) << "-";
+        cout << setw(8);
+        if (b.seeds >= 0) cout << b.seeds;
+        else cout << "-";
+        cout << setw(14) << b.peakRSS / 1024.0 << endl;
+    };
+
+    for (const string& file : instanceFiles(instances)) {
+        string graph = file.substr(0, file.size() - 7);
+        if (not only.empty() and find(only.begin(), only.end(), graph) == only.end()) continue;
+        // The kernels are timed on the RCM layout, so the seeds of the searches are not the ones of the programs
+        Graph G = readGraph(instances + "/" + file, RCM);
+        seedMonteCarlo(seed);
+        Rng draw(seed);
+        SeedSet sources(G.numNodes);
+        for (int i = 0; i < kernelSeeds; ++i) sources.insert(draw.below(G.numNodes));
+
+        LTGraph LG(G);
+        SeedSet greedyLT = greedyMinInfluenceSet(LG, r);
+
+        // Kernels (monteCarlo scans as many edges per cascade as difusioIC)
+        Rng rng(seed, 1);
+        SimulationWorkspace& ws = threadWorkspace();
+        double edgesIC = edgesPerCascade(G, ws, [&] { difusioIC(G, p, sources, rng, ws); });
+        print(benchKernel(graph, "difusioIC", edgesIC, [&](int k) {
+            for (int i = 0; i < k; ++i) difusioIC(G, p, sources, rng, ws);
+            return k;
+        }));
+        LTState st(G.numNodes);
+        int t;
+        double edgesLT = edgesPerCascade(G, st, [&] { simulateLT(G, st, r, greedyLT, t); }, 1);
+        print(benchKernel(graph, "simulateLT", edgesLT, [&](int k) {
+            for (int i = 0; i < k; ++i) simulateLT(G, st, r, greedyLT, t);
+            return k;
+        }));
+        print(benchKernel(graph, "monteCarlo", edgesIC, [&](int k) {
+            for (int i = 0; i < k; ++i) monteCarlo(G, p, sources, nMonteCarlo);
+            return k * nMonteCarlo;
+        }));
+
+        // IC searches, from the greedy solution
+        useWorlds(G, p, numWorlds, seed, "");
+        useComponents(G);
+        SeedSet greedyIC;
+        print(benchSearch(graph, "greedyMinInfluenceSet IC", [&] {
+            return greedyIC = greedyMinInfluenceSet(G, p, nMonteCarlo, optimality);
+        }));
+        print(benchSearch(graph, "localSearch IC", [&] {
+            SeedSet S = greedyIC;
+            bestImprovementLocalSearch(G, p, S, nMonteCarlo, optimality, maxSwaps);
+            return S;
+        }));
+        print(benchSearch(graph, "simulatedAnnealing IC", [&] {
+            SeedSet S = greedyIC;
+            return simulatedAnnealing(G, p, S, nMonteCarlo, optimality, maxIterIC, T, alpha, 1, 10, cacheSize);
+        }));
+        icComponents = nullptr;
+        icWorlds = nullptr;
+
+        // Every run numbers its Monte Carlo calls from 0, so that it repeats the same simulations
+        if (find(monteCarloGraphs.begin(), monteCarloGraphs.end(), graph) != monteCarloGraphs.end()) {
+            SeedSet greedyMC;
+            print(benchSearch(graph, "greedy IC MC", [&] {
+                numMonteCarloCalls = 0;
+                return greedyMC = greedyMinInfluenceSet(G, pMC, nMC, optimalityMC);
+            }));
+            print(benchSearch(graph, "localSearch IC MC", [&] {
+                numMonteCarloCalls = 0;
+                SeedSet S = greedyMC;
+                bestImprovementLocalSearch(G, pMC, S, nMC, optimalityMC, maxSwaps);
+                return S;
+            }));
+            print(benchSearch(graph, "firstImprovement IC MC", [&] {
+                numMonteCarloCalls = 0;
+                SeedSet S = greedyMC;
+                localSearch(G, pMC, S, nMC, optimalityMC, cacheSize, true);
+                return S;
+            }));
+            print(benchSearch(graph, "annealing IC MC", [&] {
+                numMonteCarloCalls = 0;
+                SeedSet S = greedyMC;
+                return simulatedAnnealing(G, pMC, S, nMC, optimalityMC, maxIterIC, T, alpha, 1, 10, cacheSize);
+            }));
+        }
+
+        // LT searches: the greedy of greedyLT.cpp, and the local search and simulated annealing from the greedy by
+        // degree, as in their programs
+        print(benchSearch(graph, "greedyMinInfluenceSet LT", [&] {
+            return greedyMinInfluenceSet(LG, r, BY_SPREAD);
+        }));
+        print(benchSearch(graph, "localSearch LT", [&] {
+            SeedSet S = greedyLT;
+            localSearch(LG, r, S);
+            return S;
+        }));
+        print(benchSearch(graph, "simulatedAnnealing LT", [&] {
+            SeedSet S = greedyLT;
+            return simulatedAnnealing(LG, r, S, maxIterLT, T, alpha, 1, 100, cacheSize, seed);
+        }));
+    }
+
+    if (save) {
+        writeResults(baselineFile, results);
+        cout << "Baseline saved to " << baselineFile << endl;
+        return 0;
+    }
+    vector<BenchResult> baseline = readResults(baselineFile);
+    if (baseline.empty()) {
+        cout << "No baseline in " << baselineFile << " (run with --save to create it)" << endl;
+        return 0;
+    }
+    int regressions = compareResults(results, baseline, tolerance, minSeconds);
+    cout << regressions << " benchmarks with regressions against " << baselineFile << endl;
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,244 @@
+#ifndef CASCADELIMIT_CPP
+#define CASCADELIMIT_CPP
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include "graph.cpp"
+#include "workspace.cpp"
+#include "seedSet.cpp"
+using namespace std;
+
+// Early exit of a cascade that only answers a threshold query (does S influence at least target nodes?):
+// - target: stop as soon as target nodes are influenced (the count returned is then at least target, but not the
+//   final one), or as soon as the target cannot be reached any more (the count returned is then below target)
+// - horizon: stop after horizon layers (time steps), counting only the nodes influenced by then
+// -1 disables either of them
+struct CascadeLimit {
+    int target;
+    int horizon;
+
+    CascadeLimit(int target = -1, int horizon = -1) : target(target), horizon(horizon) {}
+};
+
+// Connected components of a graph: comp[v] is the component of v and size[c] its number of nodes
+// A cascade never leaves the components of its seeds, and only grows in the components that still have nodes in
+// its frontier, which bounds the nodes it can still influence
+struct GraphComponents {
+    vector<int> comp;
+    vector<int> size;
+};
+
+// Components of G, computed with a BFS once per graph and cached per thread
+const GraphComponents& graphComponents(const Graph& G) {
+    thread_local uint64_t graph = 0;
+    thread_local GraphComponents C;
+    if (G.id != graph) {
+        C.comp.assign(G.numNodes, -1);
+        C.size.clear();
+        vector<int> queue;
+        for (int root = 0; root < G.numNodes; ++root) {
+            if (C.comp[root] != -1) continue;
+            int c = C.size.size();
+            C.comp[root] = c;
+            queue.assign(1, root);
+            for (size_t i = 0; i < queue.size(); ++i) {
+                for (int neighbour : G.neighbours(queue[i])) {
+                    if (C.comp[neighbour] == -1) {
+                        C.comp[neighbour] = c;
+                        queue.push_back(neighbour);
+                    }
+                }
+            }
+            C.size.push_back(queue.size());
+        }
+        graph = G.id;
+    }
+    return C;
+}
+
+// Marks of the components already counted by a bound, cleared in O(1) by moving to a new epoch
+struct ComponentMarks {
+    vector<unsigned> stamp;
+    unsigned epoch;
+
+    ComponentMarks() : epoch(0) {}
+
+    void begin(int numComponents) {
+        if ((int) stamp.size() < numComponents) stamp.assign(numComponents, 0);
+        if (++epoch == 0) {
+            fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    // Mark c, returning whether it was not marked yet
+    bool mark(int c) {
+        if (stamp[c] == epoch) return false;
+        stamp[c] = epoch;
+        return true;
+    }
+};
+
+ComponentMarks& componentMarks() {
+    thread_local ComponentMarks marks;
+    return marks;
+}
+
+// Nodes in the components of the seeds of S: no cascade from S, of either model, influences more
+long long componentMass(const Graph& G, const SeedSet& S) {
+    const GraphComponents& C = graphComponents(G);
+    ComponentMarks& marks = componentMarks();
+    marks.begin(C.size.size());
+    long long mass = 0;
+    for (int v : S) {
+        if (marks.mark(C.comp[v])) mass += C.size[C.comp[v]];
+    }
+    return mass;
+}
+
+// Whether a cascade with influenced nodes, whose components' counts are kept in ws.componentCounter and whose
+// next layer grows from frontier, can no longer reach target: it can at most fill the components of the frontier
+bool targetUnreachable(const GraphComponents& C, const SimulationWorkspace& ws, const vector<int>& frontier,
+                       long long influenced, int target) {
+    ComponentMarks& marks = componentMarks();
+    marks.begin(C.size.size());
+    long long bound = influenced;
+    for (int v : frontier) {
+        int c = C.comp[v];
+        if (marks.mark(c)) bound += C.size[c] - ws.componentCount(c);
+        if (bound >= target) return false;
+    }
+    return true;
+}
+
+// Counts of up to 64 cascades run at once, one per lane (bit) as in the bit-parallel IC kernel, kept bit-sliced:
+// word i holds bit i of the count of every lane, so adding 1 to some lanes is a ripple carry over a couple of words
+struct LaneCounter {
+    uint64_t bit[32];
+
+    // Set the count of every lane in lanes to c, and of the others to 0
+    void set(uint64_t lanes, long long c) {
+        for (int i = 0; i < 32; ++i) bit[i] = c >> i & 1 ? lanes : 0;
+    }
+
+    // Add 1 to the count of every lane in lanes
+    void add(uint64_t lanes) {
+        for (int i = 0; lanes != 0; ++i) {
+            uint64_t carry = bit[i] & lanes;
+            bit[i] ^= lanes;
+            lanes = carry;
+        }
+    }
+
+    long long get(int lane) const {
+        long long c = 0;
+        for (int i = 0; i < 32; ++i) c |= (long long) (bit[i] >> lane & 1) << i;
+        return c;
+    }
+
+    // Lanes whose count is at least t, compared from the highest bit down
+    uint64_t atLeast(long long t) const {
+        if (t <= 0) return ~0ULL;
+        if (t >> 32) return 0;
+        uint64_t greater = 0, equal = ~0ULL;
+        for (int i = 31; i >= 0; --i) {
+            if (t >> i & 1) equal &= bit[i];
+            else {
+                greater |= equal & bit[i];
+                equal &= ~bit[i];
+            }
+        }
+        return greater | equal;
+    }
+};
+
+// Target of up to 64 cascades run at once (the lanes of difusioICBitParallel): the influenced nodes of every lane are
+// counted, in total and in every component of the seeds, and a lane is decided once it reaches the target or can no
+// longer reach it. The bound is the one of targetUnreachable: the nodes a lane influenced in the components where
+// its frontier has died out, plus the size of the components where it still has a frontier
+struct LaneLimit {
+    const GraphComponents* C;
+    int target;
+    LaneCounter total;
+    // Slot of every component of the seeds, valid if stamp[c] == epoch
+    vector<unsigned> stamp;
+    vector<int> slot;
+    unsigned epoch;
+    // Per slot: its component, its seeds, the influenced nodes of every lane there and the lanes with a frontier there
+    vector<int> component, seeds;
+    vector<LaneCounter> count;
+    vector<uint64_t> active, frontierLanes;
+    // Bound of every lane on the nodes it can influence
+    long long bound[64];
+
+    LaneLimit() : epoch(0) {}
+
+    // Start the cascades of lanes with the seeds of S influenced
+    void begin(const GraphComponents& components, const SeedSet& S, uint64_t lanes, int t) {
+        C = &components;
+        target = t;
+        total.set(lanes, S.size());
+        if (stamp.size() < C->size.size()) {
+            stamp.assign(C->size.size(), 0);
+            slot.resize(C->size.size());
+        }
+        if (++epoch == 0) {
+            fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+        component.clear();
+        seeds.clear();
+        long long mass = 0;
+        for (int v : S) {
+            int c = C->comp[v];
+            if (stamp[c] != epoch) {
+                stamp[c] = epoch;
+                slot[c] = component.size();
+                component.push_back(c);
+                seeds.push_back(0);
+                mass += C->size[c];
+            }
+            ++seeds[slot[c]];
+        }
+        count.resize(max(count.size(), component.size()));
+        active.assign(component.size(), lanes);
+        frontierLanes.resize(component.size());
+        for (size_t i = 0; i < component.size(); ++i) count[i].set(lanes, seeds[i]);
+        fill(bound, bound + 64, mass);
+    }
+
+    // v gets influenced in lanes (with a single component the total is its count)
+    void influence(int v, uint64_t lanes) {
+        total.add(lanes);
+        if (component.size() > 1) count[slot[C->comp[v]]].add(lanes);
+    }
+
+    // Lanes (out of lanes) decided before the layer that grows from the nodes of frontier, mask[v] telling the lanes
+    // where v is in it
+    uint64_t decided(const vector<int>& frontier, const vector<uint64_t>& mask, uint64_t lanes) {
+        fill(frontierLanes.begin(), frontierLanes.end(), 0);
+        for (int v : frontier) frontierLanes[slot[C->comp[v]]] |= mask[v];
+        for (size_t i = 0; i < component.size(); ++i) {
+            // Lanes whose frontier in the component has just died out: they keep what they have there
+            for (uint64_t stopped = active[i] & ~frontierLanes[i]; stopped != 0; stopped &= stopped - 1) {
+                int lane = __builtin_ctzll(stopped);
+                bound[lane] += (component.size() > 1 ? count[i] : total).get(lane) - C->size[component[i]];
+            }
+            active[i] = frontierLanes[i];
+        }
+        uint64_t result = total.atLeast(target);
+        for (uint64_t l = lanes & ~result; l != 0; l &= l - 1) {
+            int lane = __builtin_ctzll(l);
+            if (bound[lane] < target) result |= 1ULL << lane;
+        }
+        return lanes & result;
+    }
+};
+
+LaneLimit& laneLimit() {
+    thread_local LaneLimit limit;
+    return limit;
+}
+
+#endif
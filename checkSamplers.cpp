@@ -0,0 +1,80 @@
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "monteCarloIC.cpp"
+using namespace std;
+
+// Statistical parity check of the IC samplers: the mean spread of GEOMETRIC and BIT_PARALLEL must match the one of
+// the per-edge coin flip (COIN_FLIP) on every graph and p, within k standard errors of the difference
+//
+//     ./checkSamplers [simulations] [graph.dimacs...]
+//
+// The seeds are a few nodes drawn at random. The bit-parallel kernel only returns the total of its 64 worlds, so its
+// standard error is computed from the means of the batches. The exit status is 1 if any sampler differs
+
+// Mean spread and its standard error
+struct SpreadEstimate {
+    double mean, se;
+};
+
+// Mean of the values and its standard error, by Welford
+SpreadEstimate estimate(const vector<double>& values) {
+    double mean = 0, m2 = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        double d = values[i] - mean;
+        mean += d / (i + 1);
+        m2 += d * (values[i] - mean);
+    }
+    return {mean, sqrt(m2 / (values.size() - 1) / values.size())};
+}
+
+SpreadEstimate sampleSpread(const Graph& G, double p, const SeedSet& S, ICSampler sampler, int simulations, uint64_t seed) {
+    SimulationWorkspace& ws = threadWorkspace();
+    Rng rng(seed, sampler);
+    vector<double> values;
+    if (sampler == BIT_PARALLEL) {
+        for (int i = 0; i < simulations / 64; ++i) values.push_back(difusioICBitParallel(G, p, S, ~0ULL, rng, ws) / 64.0);
+    }
+    else {
+        icSampler = sampler;
+        for (int i = 0; i < simulations; ++i) values.push_back(difusioIC(G, p, S, rng, ws));
+    }
+    return estimate(values);
+}
+
+int main(int argc, char* argv[]) {
+    int simulations = argc > 1 ? atoi(argv[1]) : 6400;
+    vector<string> graphs;
+    for (int i = 2; i < argc; ++i) graphs.push_back(argv[i]);
+    if (graphs.empty()) graphs = {"instances/graph_jazz.dimacs", "instances/socfb-Mich67.dimacs"};
+    vector<double> probabilities = {0.01, 0.05, 0.1, 0.3};
+    uint64_t seed = 12345;
+    int numSeeds = 5;
+    // Allowed difference, in standard errors (a false alarm has probability about 6e-5 per comparison)
+    double k = 4;
+
+    int failures = 0;
+    for (const string& path : graphs) {
+        Graph G = readGraph(path, RCM);
+        Rng draw(seed);
+        SeedSet S(G.numNodes);
+        while ((int) S.size() < numSeeds) S.insert(draw.below(G.numNodes));
+        for (double p : probabilities) {
+            SpreadEstimate coin = sampleSpread(G, p, S, COIN_FLIP, simulations, seed);
+            cout << path << ", p = " << p << ": COIN_FLIP " << coin.mean << " +- " << coin.se << endl;
+            for (ICSampler sampler : {GEOMETRIC, BIT_PARALLEL}) {
+                SpreadEstimate other = sampleSpread(G, p, S, sampler, simulations, seed);
+                double z = (other.mean - coin.mean) / sqrt(coin.se * coin.se + other.se * other.se);
+                bool ok = fabs(z) <= k;
+                if (not ok) ++failures;
+                cout << "    " << (sampler == GEOMETRIC ? "GEOMETRIC   " : "BIT_PARALLEL") << " " << other.mean << " +- "
+                     << other.se << " (" << z << " standard errors)" << (ok ? "" : " FAILED") << endl;
+            }
+        }
+    }
+    icSampler = BIT_PARALLEL;
+    cout << (failures == 0 ? "All samplers agree" : to_string(failures) + " samplers differ") << endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,222 @@
+#ifndef COMPONENTSIC_CPP
+#define COMPONENTSIC_CPP
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include "graph.cpp"
+#include "parallel.cpp"
+#include "workspace.cpp"
+#include "seedSet.cpp"
+#include "worldsIC.cpp"
+#include "indexedHeap.cpp"
+using namespace std;
+
+// Condensation of the live-edge worlds (pruned Monte Carlo, Ohsaka et al. 2014; StaticGreedy, Cheng et al. 2013)
+// The worlds of an undirected graph are undirected, so the nodes influenced by S in a world are the union of the
+// connected components of its seeds. Storing the component of every node in every world, the spread of S and the
+// marginal gain of a node become lookups, with no cascade at all
+// Components are numbered globally: comp[w * n + v] is the component of v in world w and size[c] its number of nodes
+// (with directed graphs these would be the strongly connected components plus the reachability between them)
+struct WorldComponents {
+    int numWorlds;
+    int numNodes;
+    vector<int> comp;
+    vector<int> size;
+
+    WorldComponents() : numWorlds(0), numNodes(0) {}
+
+    int component(int w, int v) const {
+        return comp[(size_t) w * numNodes + v];
+    }
+};
+
+// Label the components of every world with a BFS over its live arcs; the worlds are labelled in parallel and their
+// local ids shifted afterwards, so the numbering does not depend on the number of threads
+void condenseWorlds(const Graph& G, const LiveEdgeWorlds& W, WorldComponents& C) {
+    int n = G.numNodes;
+    C.numWorlds = W.numWorlds;
+    C.numNodes = n;
+    C.comp.assign((size_t) W.numWorlds * n, -1);
+    vector<vector<int> > localSize(W.numWorlds);
+    parallelFor(W.numWorlds, [&](int w) {
+        const uint64_t* live = W.batch(w / 64);
+        uint64_t bit = 1ULL << (w % 64);
+        int* comp = C.comp.data() + (size_t) w * n;
+        SimulationWorkspace& ws = threadWorkspace();
+        for (int root = 0; root < n; ++root) {
+            if (comp[root] != -1) continue;
+            int c = localSize[w].size();
+            ws.begin(n);
+            comp[root] = c;
+            ws.frontier.push_back(root);
+            int count = 1;
+            while (not ws.frontier.empty()) {
+                for (int v : ws.frontier) {
+                    for (int e = G.offset[v]; e < G.offset[v + 1]; ++e) {
+                        int neighbour = G.adj[e];
+                        if ((live[e] & bit) and comp[neighbour] == -1) {
+                            comp[neighbour] = c;
+                            ++count;
+                            ws.next.push_back(neighbour);
+                        }
+                    }
+                }
+                ws.advance();
+            }
+            localSize[w].push_back(count);
+        }
+    });
+    vector<int> base(W.numWorlds + 1, 0);
+    for (int w = 0; w < W.numWorlds; ++w) base[w + 1] = base[w] + localSize[w].size();
+    C.size.resize(base[W.numWorlds]);
+    parallelFor(W.numWorlds, [&](int w) {
+        int* comp = C.comp.data() + (size_t) w * n;
+        for (int v = 0; v < n; ++v) comp[v] += base[w];
+        copy(localSize[w].begin(), localSize[w].end(), C.size.begin() + base[w]);
+    });
+}
+
+// Seed set evaluated on the condensed worlds: how many seeds cover every component, and the total number of
+// influenced nodes over all the worlds, updated as seeds come and go
+struct ComponentCover {
+    const WorldComponents* C;
+    vector<int> seeds;
+    long long total;
+
+    ComponentCover(const WorldComponents& C) : C(&C), seeds(C.size.size(), 0), total(0) {}
+
+    // Average spread over the worlds, rounded down as monteCarlo does
+    int spread() const {
+        return total / C->numWorlds;
+    }
+
+    // Nodes that v would add over all the worlds (covered components add nothing)
+    long long gain(int v) const {
+        long long g = 0;
+        for (int w = 0; w < C->numWorlds; ++w) {
+            int c = C->component(w, v);
+            if (seeds[c] == 0) g += C->size[c];
+        }
+        return g;
+    }
+
+    // Nodes lost over all the worlds if the seed v is removed (components covered only by v)
+    long long loss(int v) const {
+        long long l = 0;
+        for (int w = 0; w < C->numWorlds; ++w) {
+            int c = C->component(w, v);
+            if (seeds[c] == 1) l += C->size[c];
+        }
+        return l;
+    }
+
+    // Total over the worlds if the seeds a and b (b may be -1) were replaced by the node c, leaving the cover as it is
+    long long totalAfterSwap(int a, int b, int c) const {
+        long long t = total;
+        for (int w = 0; w < C->numWorlds; ++w) {
+            int ca = C->component(w, a);
+            int cb = b != -1 ? C->component(w, b) : -1;
+            int cc = C->component(w, c);
+            if (seeds[ca] == (cb == ca ? 2 : 1) and cc != ca) t -= C->size[ca];
+            if (cb != -1 and cb != ca and seeds[cb] == 1 and cc != cb) t -= C->size[cb];
+            if (seeds[cc] == 0) t += C->size[cc];
+        }
+        return t;
+    }
+
+    void add(int v) {
+        for (int w = 0; w < C->numWorlds; ++w) {
+            int c = C->component(w, v);
+            if (seeds[c]++ == 0) total += C->size[c];
+        }
+    }
+
+    void remove(int v) {
+        for (int w = 0; w < C->numWorlds; ++w) {
+            int c = C->component(w, v);
+            if (--seeds[c] == 0) total -= C->size[c];
+        }
+    }
+};
+
+// Average spread of S over the condensed worlds: every distinct component of a seed counts once per world
+int componentSpread(const WorldComponents& C, const SeedSet& S) {
+    thread_local vector<int> comps;
+    long long total = 0;
+    for (int w = 0; w < C.numWorlds; ++w) {
+        comps.clear();
+        for (int v : S) comps.push_back(C.component(w, v));
+        sort(comps.begin(), comps.end());
+        for (size_t i = 0; i < comps.size(); ++i) {
+            if (i == 0 or comps[i] != comps[i - 1]) total += C.size[comps[i]];
+        }
+    }
+    return total / C.numWorlds;
+}
+
+// Greedy minimum influence set on the condensed worlds: the gain of a node is the size of the components it covers
+// that are not covered yet, so the lazy greedy needs no simulation. Gains only decrease as S grows, so a node whose
+// recomputed gain is still on top of the heap is the best one
+SeedSet componentMinInfluenceSet(const WorldComponents& C, double optimality) {
+    int n = C.numNodes;
+    SeedSet S(n);
+    ComponentCover cover(C);
+    IndexedHeap Q(n);
+    vector<int> flag(n, 0);
+    for (int v = 0; v < n; ++v) Q.push(v, cover.gain(v));
+    long long evaluations = 0;
+    while (not Q.empty() and cover.spread() < optimality * n) {
+        int u = Q.top();
+        if (flag[u] == (int) S.size()) {
+            if (Q.key[u] == 0) break;
+            S.insert(u);
+            cover.add(u);
+            Q.pop();
+            continue;
+        }
+        Q.update(u, cover.gain(u));
+        flag[u] = S.size();
+        ++evaluations;
+    }
+    cerr << "Condensed worlds: " << C.size.size() << " components in " << C.numWorlds << " worlds, " << evaluations
+         << " gain lookups after the first round" << endl;
+    return S;
+}
+
+// Local search on the condensed worlds: remove the seeds whose removal keeps the spread and the target, where the
+// spread lost by a seed is the size of the components that only it covers
+void componentLocalSearch(const WorldComponents& C, SeedSet& S, double optimality) {
+    ComponentCover cover(C);
+    for (int v : S) cover.add(v);
+    bool improvement = true;
+    while (improvement) {
+        improvement = false;
+        for (size_t i = 0; i < S.size(); ) {
+            int currentInfluence = cover.spread();
+            int tempInfluence = (cover.total - cover.loss(S[i])) / C.numWorlds;
+            if (tempInfluence >= currentInfluence && tempInfluence >= optimality * C.numNodes) {
+                improvement = true;
+                cover.remove(S[i]);
+                // The last seed takes the place of the removed one and is checked next
+                S.erase(S[i]);
+            }
+            else ++i;
+        }
+    }
+}
+
+// Components of the worlds used instead of the cascades, if any
+const WorldComponents* icComponents = nullptr;
+
+// Condense the worlds in use (see useWorlds) so that spreads and gains are computed on their components
+void useComponents(const Graph& G) {
+    static WorldComponents components;
+    condenseWorlds(G, *icWorlds, components);
+    cerr << "Condensed worlds: " << (double) components.size.size() / components.numWorlds
+         << " components per world on average" << endl;
+    icComponents = &components;
+}
+
+#endif
@@ -2,30 +2,23 @@
 #include <vector>
 #include <queue>
 #include <ctime>
+#include <chrono>
+#include "graph.cpp"
+#include "rng.cpp"
+#include "workspace.cpp"
 using namespace std;
 
-// Struct for undirected graph
-struct Graph {
+// Edges of the graph while it is being read, turned into a CSR Graph once complete
+struct EdgeList {
     int numNodes;
-    vector<vector<int> > adjList;
+    vector<pair<int, int> > edges;
 
-    // Graph constructor:
-    Graph(int n) {
+    EdgeList(int n) {
         numNodes = n;
-        adjList.resize(n);
-    }
-
-    Graph() {
-    }
-
-    //Getters
-    int getNumNodes(){
-        return numNodes;
     }
 
     void addEdge(int u, int v) {
-        adjList[u].push_back(v);
-        adjList[v].push_back(u);
+        edges.push_back(make_pair(u, v));
     }
 
     //Reeds
@@ -64,17 +57,10 @@ struct Graph {
 
         for(int i = 0; i < m; ++i){
             cin >> c >> u >> v;
-            addEdge(u,v);
+            addEdge(u-1,v-1);
         }
 
     }
-
-    //Print
-    void printEdges() {
-        for (int vertex = 0; vertex < adjList.size(); ++vertex) {
-            for (int neighbour : adjList[vertex]) cout << vertex << " -> " << neighbour << endl;
-        }
-    }
 };
 
 struct Subset{
@@ -128,48 +114,45 @@ struct Subset{
 };
 
 // Simulate IC difusion process
-int simulateIC(Graph& G, double& p, Subset& S, int& t) {
-    // Set of influenced nodes
-    vector<bool> influenced(G.numNodes, false);
-    // Set of active nodes (per iteration)
-    queue<int> active;
+int simulateIC(Graph& G, double& p, Subset& S, int& t, Rng& rng, SimulationWorkspace& ws) {
+    // Influenced nodes are marked in ws, the active nodes of every iteration are its frontier
+    ws.begin(G.numNodes);
+    int count = 0;
     
     t = 0;
 
     // Activate initial set of nodes
     for (int vertex : S.getVector()) {
-        influenced[vertex] = true;
-        active.push(vertex);
+        if (ws.visited(vertex)) continue;
+        ws.visit(vertex);
+        ++count;
+        ws.frontier.push_back(vertex);
     }
 
     // Continue untill no more active nodes
-    while (not active.empty()) {
+    while (not ws.frontier.empty()) {
         ++t;
-        int numCurrentActive = active.size();
 
         // Process all active nodes in the current layer
-        for (int i = 0; i < numCurrentActive; ++i) {
-            int v = active.front();
-            active.pop();
+        for (int v : ws.frontier) {
             
             // Check neighbours of v
-            for (int j = 0; j < G.adjList[v].size(); ++j) {
-                int neighbour = G.adjList[v][j];
+            for (int neighbour : G.neighbours(v)) {
                  
                 // If neighbor is not already active, try to activate it
-                if (not influenced[neighbour]) {
-                    double r = (double) rand() / RAND_MAX;
+                if (not ws.visited(neighbour)) {
+                    double r = rng.uniform();
                     if (r < p) {
-                        influenced[neighbour] = true;
-                        active.push(neighbour);
+                        ws.visit(neighbour);
+                        ++count;
+                        ws.next.push_back(neighbour);
                     }
                 }
             }
         }
+        ws.advance();
     }
 
-    int count = 0;
-    for (int i = 0; i < influenced.size(); ++i) if (influenced[i]) ++count; 
     return count;
 }
 
@@ -185,15 +168,16 @@ void readInput(Graph& G, double& p, Subset& S) {
         cin >> s;
         cin >> n >> m;
 
-        G = Graph(n);
-        G.readFromFile(m);
+        EdgeList E(n);
+        E.readFromFile(m);
+        G = buildGraph(n, E.edges);
     } else{
     
         cout << "Enter number of nodes: ";
         cin >> n;
         cout << "Enter number of edges: ";
         cin >> m;
-        G = Graph(n);
+        EdgeList E(n);
 
         cout << "If you prefer a Graph Random Initialitzation write R, if you wanna do it Manual write M" << endl;
         
@@ -205,7 +189,7 @@ void readInput(Graph& G, double& p, Subset& S) {
         }
 
         if(controlChar == 'M') 
-            G.readEdges(m);
+            E.readEdges(m);
         
         else{
             cout << "Please, give me a Random Seed: ";
@@ -214,8 +198,10 @@ void readInput(Graph& G, double& p, Subset& S) {
             cin >> randSeed;
             srand(randSeed);
 
-            G.randomInitEdges(m);
+            E.randomInitEdges(m);
         }
+
+        G = buildGraph(n, E.edges);
     }
 
     int s;
@@ -246,21 +232,22 @@ void readInput(Graph& G, double& p, Subset& S) {
 
 int main() {
 
-    // Generate random seed for proper random values
-    unsigned seed = chrono::high_resolution_clock::now().time_since_epoch().count();
+    // Generate random seed for proper random values (set TSS_SEED to replay a run)
+    uint64_t seed = chooseSeed();
     srand(seed);
+    Rng rng(seed);
 
     Graph G;
     double p;
     Subset S;
     readInput(G, p, S);
-    cout << "NumNodes " << G.getNumNodes() << endl;
+    cout << "NumNodes " << G.numNodes << endl;
     cout << "Size of seed " << S.getSeedSize() << endl;
     
     time_t startTime = time(NULL);
 
     int t = 0;
-    int C = simulateIC(G, p, S, t);
+    int C = simulateIC(G, p, S, t, rng, threadWorkspace());
 
     time_t endTime = time(NULL);
     
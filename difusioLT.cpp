@@ -1,131 +1,429 @@
+#ifndef DIFUSIOLT_CPP
+#define DIFUSIOLT_CPP
+
 #include <iostream>
 #include <vector>
 #include <queue>
 #include <chrono>
+#include <cmath>
+#include "graph.cpp"
+#include "parallel.cpp"
+#include "workspace.cpp"
+#include "seedSet.cpp"
+#include "cascadeLimit.cpp"
 using namespace std;
 using namespace std::chrono;
-using Subset = vector<int>;
 
-// Struct for undirected graph
-struct Graph {
-    int numNodes;
-    vector<vector<int>> adjList;
-    vector<bool> influenced;
-    vector<int> peso;
+// State of an LT diffusion, kept in a SimulationWorkspace: the visit marks tell the influenced nodes and the
+// counters their weight, so graphreset() is O(1)
+// While trailing is set, every change is recorded in trail so that it can be undone with rollback()
+// If components is set the influenced nodes of every component are counted too, for the cascades with a target
+struct LTState : SimulationWorkspace {
+    // Number of influenced nodes
+    int numInfluenced;
+    bool trailing;
+    // v for an increment of peso[v], ~v when v gets influenced
+    vector<int> trail;
+    const GraphComponents* components;
+    // One bit per node, set if it is influenced, for the layers of propagateLT that pull their weights
+    vector<uint64_t> influencedBits;
+
+    LTState(int n) : SimulationWorkspace(n), numInfluenced(0), trailing(false), components(nullptr) {
+        begin(n);
+    }
+
+    bool influenced(int v) const {
+        return visited(v);
+    }
+
+    int peso(int v) const {
+        return count(v);
+    }
 
-    // Graph constructor:
-    Graph(int n) : numNodes(n), adjList(n), influenced(n), peso(n) {}
+    void influence(int v) {
+        visit(v);
+        ++numInfluenced;
+        if (components != nullptr) incrementComponent(components->comp[v]);
+        if (trailing) trail.push_back(~v);
+    }
 
-    void addEdge(int u, int v) {
-        adjList[u].push_back(v);
-        adjList[v].push_back(u);
+    void addPeso(int v) {
+        increment(v);
+        if (trailing) trail.push_back(v);
     }
 
-    void actualizarpesovecinos(int x) {
-        for (auto neighbor : adjList[x]) ++peso[neighbor];
+    // Undo the changes recorded after the trail had the given size
+    void rollback(size_t mark) {
+        while (trail.size() > mark) {
+            int e = trail.back();
+            trail.pop_back();
+            if (e >= 0) decrement(e);
+            else {
+                unvisit(~e);
+                --numInfluenced;
+                if (components != nullptr) decrementComponent(components->comp[~e]);
+            }
+        }
     }
+
     // Reset del grafo
     void graphreset(){
-        fill(influenced.begin(), influenced.end(),false);
-        fill(peso.begin(), peso.end(),0);
+        begin(mark.size());
+        numInfluenced = 0;
+        trail.clear();
+        components = nullptr;
     }
 };
 
-int simulateLT(Graph& G, double r, Subset& S, int& t) {
-    queue<int> active;
-    t = -1;
-    G.graphreset();
-    // Activate initial set of nodes
-    for (auto vertex : S) {
-        G.influenced[vertex] = true;
-        G.actualizarpesovecinos(vertex);
-        active.push(vertex);
-    }
-    int n_influenced = active.size();
-    queue<int> influencedAux;
-    // Continue until no more active nodes
-    while (!active.empty()) {
-        ++t;
-        int numCurrentActive = active.size();
-        // Process all active nodes in the current layer
-        for (int i = 0; i < numCurrentActive; ++i) {
-            int v = active.front();
-            active.pop();
-            // Check neighbours of v
-            for (auto neighbor : G.adjList[v]) {
-                // If neighbor is not already active, try to activate it
-                if (!G.influenced[neighbor]) {
-                    double l = r * G.adjList[neighbor].size();
-                    if (G.peso[neighbor] >= l) {
-                        G.influenced[neighbor] = true;
-                        influencedAux.push(neighbor);
-                        ++n_influenced;
-                    }
-                }
+// Undirected graph together with the state of the LT diffusion
+struct LTGraph : Graph, LTState {
+    // LTGraph constructor:
+    LTGraph(Graph G) : Graph(move(G)), LTState(numNodes) {}
+};
+
+// Integer thresholds of the LT model for the ratio r: v is influenced once peso(v) >= r * deg(v), that is once
+// peso(v) reaches threshold[v], the smallest such integer (at least 1, since only a neighbour can activate v)
+// Computed once per graph and r, and cached per thread
+const vector<int>& ltThresholds(const Graph& G, double r) {
+    thread_local uint64_t graph = 0;
+    thread_local double ratio = -1;
+    thread_local vector<int> threshold;
+    if (G.id != graph or r != ratio) {
+        threshold.resize(G.numNodes);
+        for (int v = 0; v < G.numNodes; ++v) {
+            double l = r * G.degree(v);
+            int k = max(0.0, ceil(l));
+            while (k > 0 and k - 1 >= l) --k;
+            while (k < l) ++k;
+            threshold[v] = max(k, 1);
+        }
+        graph = G.id;
+        ratio = r;
+    }
+    return threshold;
+}
+
+// Minimum number of edges of a layer for propagateLT to add its weights on all the threads
+long long parallelLTEdges = 1 << 15;
+
+// Add the weight of the nodes of st.frontier to their neighbours on all the threads, appending to st.next the ones
+// that reach their threshold. Increments are atomic, so exactly one thread sees the count of a node reach its
+// threshold and the candidates are found once, whatever the interleaving. The trail of every task is appended
+// afterwards: rollback() only decrements, so the order of the entries does not matter
+void addWeightsParallel(const Graph& G, LTState& st, const int* threshold) {
+    const int grain = 256;
+    int tasks = (st.frontier.size() + grain - 1) / grain;
+    vector<vector<int> > found(tasks), trails(st.trailing ? tasks : 0);
+    parallelFor(tasks, [&](int i) {
+        int end = min<int>(st.frontier.size(), (i + 1) * grain);
+        for (int j = i * grain; j < end; ++j) {
+            for (auto neighbor : G.neighbours(st.frontier[j])) {
+                int c = st.incrementAtomic(neighbor);
+                if (st.trailing) trails[i].push_back(neighbor);
+                if (c == threshold[neighbor] and !st.influenced(neighbor)) found[i].push_back(neighbor);
+            }
+        }
+    });
+    for (int i = 0; i < tasks; ++i) {
+        st.next.insert(st.next.end(), found[i].begin(), found[i].end());
+        if (st.trailing) st.trail.insert(st.trail.end(), trails[i].begin(), trails[i].end());
+    }
+}
+
+// A layer of propagateLT pulls the weights instead of pushing them when the edges of its frontier, times
+// pullLTFactor, are more than the nodes plus the edges of the nodes not influenced yet, which a pulled layer reads
+// Push adds the weight of every node once, so unlike in a BFS pull seldom saves much: the factor is kept low
+double pullLTFactor = 1;
+
+// Pull the weights of a layer: every node not influenced yet counts its influenced neighbours in st.influencedBits
+// (n bits, which stay in cache where the marks do not) and becomes a candidate, appended to st.next, if they reach
+// its threshold. The others get the weight push would give them, so the next layers can push again. A candidate
+// stops counting at its first neighbour not influenced past the threshold: its weight is only read again in the next
+// layer, to skip it if all its neighbours are influenced, and is equal to its degree exactly when that holds
+// The nodes are split in ranges on all the threads if parallel; the candidates come out in node order either way
+void pullWeights(const Graph& G, LTState& st, const int* threshold, bool parallel) {
+    const uint64_t* bits = st.influencedBits.data();
+    auto pull = [&](int first, int last, vector<int>& found) {
+        for (int v = first; v < last; ++v) {
+            if (bits[v >> 6] >> (v & 63) & 1) continue;
+            int c = 0;
+            for (int w : G.neighbours(v)) {
+                if (bits[w >> 6] >> (w & 63) & 1) ++c;
+                else if (c >= threshold[v]) break;
             }
+            st.setCount(v, c);
+            if (c >= threshold[v]) found.push_back(v);
+        }
+    };
+    if (not parallel) {
+        pull(0, G.numNodes, st.next);
+        return;
+    }
+    const int grain = 4096;
+    int tasks = (G.numNodes + grain - 1) / grain;
+    vector<vector<int> > found(tasks);
+    parallelFor(tasks, [&](int i) {
+        pull(i * grain, min(G.numNodes, (i + 1) * grain), found[i]);
+    });
+    for (int i = 0; i < tasks; ++i) st.next.insert(st.next.end(), found[i].begin(), found[i].end());
+}
+
+// Propagate the diffusion from the nodes in st.frontier, which are influenced but have not added their weight to
+// their neighbours yet, until no more nodes get activated or, if stopAt is a node, as soon as it gets influenced
+// It also stops as told by limit (see cascadeLimit.cpp): once limit.target nodes are influenced, once they cannot
+// be (only if st counts its components), or after limit.horizon layers. A diffusion stopped by the limit is not
+// complete, so nodes must not be added to it incrementally afterwards
+// A node becomes a candidate (in st.next) when the weight it receives reaches its threshold, so every layer only
+// touches the edges of the nodes activated in the previous one, once
+// Layers with at least parallelLTEdges edges add their weights in parallel (addWeightsParallel). The nodes that
+// add weight are chosen before any weight of the layer is added, so every layer, and the result, is the same
+// with any number of threads
+// With pull, which needs st.frontier to hold every influenced node and st not to be trailing (as simulateLT leaves
+// it), the layers with a wide frontier (see pullLTFactor) pull the weights instead (pullWeights): the wide middle
+// layers of a large cascade then cost the edges of the nodes left, read sequentially, instead of scattered updates
+// The layers and the result are the same either way
+// Returns the number of layers
+int propagateLT(const Graph& G, LTState& st, double r, int stopAt = -1, const CascadeLimit& limit = CascadeLimit(),
+                bool pull = false) {
+    const int* threshold = ltThresholds(G, r).data();
+    bool parallel = threadPool().numThreads() > 1 and not ThreadPool::insideWorker();
+    // Edges of the nodes not influenced yet, -1 without pull
+    long long unvisitedEdges = -1;
+    if (pull and not st.trailing) {
+        unvisitedEdges = G.offset[G.numNodes];
+        for (int u : st.frontier) unvisitedEdges -= G.degree(u);
+    }
+    // Whether st.influencedBits holds the influenced nodes (it is only kept up to date by the pulled layers)
+    bool bitsValid = false;
+    int t = -1;
+    st.next.clear();
+    while (true) {
+        if (limit.horizon >= 0 and t + 1 >= limit.horizon) break;
+        if (limit.target >= 0 and st.numInfluenced >= limit.target) break;
+        if (limit.target >= 0 and st.components != nullptr and
+            targetUnreachable(*st.components, st, st.frontier, st.numInfluenced, limit.target)) break;
+        // The influenced nodes become active and update their weights (unless all their neighbours are influenced)
+        bool seeds = t < 0 and not st.frontier.empty();
+        int numActive = 0;
+        long long edges = 0;
+        for (int u : st.frontier) {
+            if (st.peso(u) == G.degree(u)) continue;
+            st.frontier[numActive++] = u;
+            edges += G.degree(u);
         }
-        // Move influencedAux nodes to active and update their weights
-        while (!influencedAux.empty()) {
-            int u = influencedAux.front();
-            influencedAux.pop();
-            if (G.peso[u] != G.adjList[u].size()) {
-                active.push(u);
-                ++G.peso[u];
-                for (auto neighbor : G.adjList[u]) {
-                    ++G.peso[neighbor];
+        st.frontier.resize(numActive);
+        // Continue until no more active nodes (the seeds always make a layer)
+        if (numActive == 0 and not seeds) break;
+        bool pulled = unvisitedEdges >= 0 and edges * pullLTFactor > unvisitedEdges + G.numNodes;
+        if (pulled) {
+            if (not bitsValid) {
+                st.influencedBits.assign((G.numNodes + 63) / 64, 0);
+                for (int v = 0; v < G.numNodes; ++v) {
+                    if (st.influenced(v)) st.influencedBits[v >> 6] |= 1ULL << (v & 63);
                 }
+                bitsValid = true;
+            }
+            pullWeights(G, st, threshold, parallel and unvisitedEdges >= parallelLTEdges);
+        }
+        else if (parallel and edges >= parallelLTEdges) addWeightsParallel(G, st, threshold);
+        else for (int u : st.frontier) {
+            for (auto neighbor : G.neighbours(u)) {
+                st.addPeso(neighbor);
+                if (st.peso(neighbor) == threshold[neighbor] and !st.influenced(neighbor)) st.next.push_back(neighbor);
             }
         }
+        bitsValid = pulled;
+        ++t;
+        // Activate the candidates of this layer
+        st.frontier.clear();
+        for (int v : st.next) {
+            if (st.influenced(v)) continue;
+            st.influence(v);
+            if (pulled) st.influencedBits[v >> 6] |= 1ULL << (v & 63);
+            if (unvisitedEdges >= 0) unvisitedEdges -= G.degree(v);
+            if (v == stopAt) return t;
+            st.frontier.push_back(v);
+        }
+        st.next.clear();
+    }
+    st.frontier.clear();
+    return t;
+}
+
+// Activate the seeds of S in st and propagate the diffusion from them, skipping the node skip if it is given
+// Stops as soon as stopAt gets influenced or as told by limit, as propagateLT; with a target the components are
+// counted, so the cascade also stops when the target cannot be reached
+// The cascade starts from scratch, so its wide layers are pulled (see propagateLT)
+int simulateLT(const Graph& G, LTState& st, double r, const SeedSet& S, int& t, int skip = -1, int stopAt = -1,
+               const CascadeLimit& limit = CascadeLimit()) {
+    st.graphreset();
+    if (limit.target >= 0) st.components = &graphComponents(G);
+    // Activate initial set of nodes
+    for (auto vertex : S) {
+        if (vertex == skip or st.influenced(vertex)) continue;
+        st.influence(vertex);
+        st.frontier.push_back(vertex);
+    }
+    t = propagateLT(G, st, r, stopAt, limit, true);
+    return st.numInfluenced;
+}
+
+int simulateLT(LTGraph& G, double r, SeedSet& S, int& t) {
+    return simulateLT(G, G, r, S, t);
+}
+
+// Add a seed to the diffusion stored in G (by simulateLT or previous calls) propagating only from it
+// The threshold model is deterministic and monotone, so the result is the same as simulating S + {seed} from scratch,
+// but the cost is only the work of the newly activated nodes
+// With a target it stops as soon as target nodes are influenced (then G can only be rolled back or discarded)
+int addSeedLT(LTGraph& G, double r, int seed, int target = -1) {
+    if (G.influenced(seed)) return G.numInfluenced;
+    G.frontier.clear();
+    G.influence(seed);
+    G.frontier.push_back(seed);
+    propagateLT(G, G, r, -1, CascadeLimit(target));
+    return G.numInfluenced;
+}
+
+// Whether the seed x can be removed from S without changing the influenced set
+// By monotonicity this happens exactly when S - {x} influences x, so the cascade of S - {x} stops as soon as x
+// is reached; only when x is really needed does it run to the end
+// If S influences the whole graph, S - {x} has to as well, and the cascade also stops as soon as it cannot (e.g. at
+// once when no other seed shares the component of x)
+bool redundantSeedLT(const LTGraph& G, double r, const SeedSet& S, int x) {
+    thread_local LTState scratch(0);
+    scratch.resize(G.numNodes);
+    int t;
+    CascadeLimit limit(G.numInfluenced == G.numNodes ? G.numNodes : -1);
+    simulateLT(G, scratch, r, S, t, x, x, limit);
+    return scratch.influenced(x);
+}
+
+// Remove in order every seed of S[l, r) that is redundant, given that G holds the diffusion of the seeds of S
+// outside [l, r) that are kept (all the later ones, and the earlier ones that were not removed)
+// Every half is solved with the other half added incrementally and then rolled back, so a pass over S costs
+// O(log |S|) incremental propagations per seed instead of one full cascade per seed
+void removeRedundantSeedsLT(LTGraph& G, double r, const SeedSet& S, vector<bool>& keep, int l, int rr) {
+    if (rr - l == 1) {
+        keep[l] = not G.influenced(S[l]);
+        return;
     }
-    return n_influenced;
+    int m = (l + rr) / 2;
+    size_t mark = G.trail.size();
+    for (int i = m; i < rr; ++i) addSeedLT(G, r, S[i]);
+    removeRedundantSeedsLT(G, r, S, keep, l, m);
+    G.rollback(mark);
+    for (int i = l; i < m; ++i) if (keep[i]) addSeedLT(G, r, S[i]);
+    removeRedundantSeedsLT(G, r, S, keep, m, rr);
+    G.rollback(mark);
+}
+
+// Remove the redundant seeds of S one after the other, as the first improvement local search does with
+// simulateLT(S - {x}) == simulateLT(S). Leaves in G the diffusion of the resulting S
+void removeRedundantSeedsLT(LTGraph& G, double r, SeedSet& S) {
+    if (S.empty()) return;
+    vector<bool> keep(S.size());
+    G.graphreset();
+    G.trailing = true;
+    removeRedundantSeedsLT(G, r, S, keep, 0, S.size());
+    G.trailing = false;
+    SeedSet kept(G.numNodes);
+    for (size_t i = 0; i < S.size(); ++i) if (keep[i]) kept.insert(S[i]);
+    S = kept;
+    int t;
+    simulateLT(G, r, S, t);
+}
+
+// Influence of S + {x}, given that G holds the diffusion of S, leaving G unchanged
+// With a target, only whether it reaches target nodes is needed: the cascade stops there
+int influenceWithSeedLT(LTGraph& G, double r, int x, int target = -1) {
+    if (target >= 0 and G.numInfluenced >= target) return G.numInfluenced;
+    bool trailing = G.trailing;
+    size_t mark = G.trail.size();
+    G.trailing = true;
+    int influence = addSeedLT(G, r, x, target);
+    G.rollback(mark);
+    G.trailing = trailing;
+    return influence;
 }
 
-Graph readGraph() {
-    char p;
-    string edge;
-    cin >> p >> edge;
-    int n, m;
-    cin >> n >> m;
+// Orders in which the greedy algorithm considers the candidate seeds: by degree, or by the spread of each node alone
+enum GreedyOrder { BY_DEGREE, BY_SPREAD };
 
-    Graph G(n);
+// Greedy algorithm to select the minimum influence set
+// Nodes are added in the given order, skipping those already influenced, until the whole graph is influenced
+SeedSet greedyMinInfluenceSet(LTGraph& G, double r, GreedyOrder order = BY_DEGREE) {
+    SeedSet S(G.numNodes);
+    priority_queue<pair<int,int>> gain;
 
-    char e;
-    int u, v;
-    for (int i = 0; i < m; ++i) {
-        cin >> e >> u >> v;
-        G.addEdge(u - 1, v - 1);
+    if (order == BY_SPREAD) {
+        // Ordenar el vector de nodos por ganancia marginal
+        // The spreads of the single nodes are independent, so they are computed in parallel, every thread with its
+        // own state; the nodes are taken one at a time, so a few expensive cascades do not unbalance the threads
+        vector<int> spread(G.numNodes);
+        ProgressCounter progress("Singleton spreads", G.numNodes, "nodes", "influenced nodes");
+        parallelFor(G.numNodes, [&](int i) {
+            thread_local LTState scratch(0);
+            scratch.resize(G.numNodes);
+            thread_local SeedSet s;
+            s.clear();
+            s.insert(i);
+            int t = 0;
+            spread[i] = simulateLT(G, scratch, r, s, t);
+            progress.add(1, spread[i]);
+        });
+        progress.summary();
+        for (int i = 0; i < G.numNodes; ++i) gain.push(make_pair(spread[i], i));
+    }
+    else {
+        // Ordenar el vector de nodos por grado de aristas
+        for (int i = 0; i < G.numNodes; ++i) {
+            gain.push(make_pair(G.degree(i), i));
+        }
     }
 
-    return G;
+    // Mientras aún haya nodos con ganancia marginal positiva y difusio(G, p, S) != |V|
+    G.graphreset();
+    while (!gain.empty()) {
+        int node = gain.top().second;
+        gain.pop();
+        while (G.influenced(node)) {
+            node = gain.top().second;
+            gain.pop();
+        }
+        S.insert(node);
+        if (addSeedLT(G, r, node, G.numNodes) == G.numNodes) break;
+    }
+    return S;
 }
 
-Subset readInputSubset() {
+SeedSet readInputSubset() {
     int s;
     cout << "Enter number of nodes in the initial seed: ";
     cin >> s;
     cout << "Enter " << s << " nodes for the initial seed: ";
-    Subset S(s);
+    SeedSet S;
     for (int i = 0; i < s; ++i) {
         int u;
         cin >> u;
-        S.push_back(u);
+        S.insert(u);
     }
     return S;
 }
 
-void printSet(Subset& S) {
+void printSet(const Graph& G, SeedSet& S) {
     cout << "Initial set: {";
     int n = S.size() - 1;
     for (int i = 0; i < n; ++i) {
-        cout << S[i] << ", " ;
+        cout << G.originalId[S[i]] << ", " ;
     }
-    cout << S[n] << '}' << endl;
+    cout << G.originalId[S[n]] << '}' << endl;
 }
 
 /*
 int main() {
-    Graph G = readGraph();
-    Subset S = readInputSubset();
+    LTGraph G = readGraph();
+    SeedSet S = readInputSubset();
     double r = 0.5;
     int t = 0;
 
@@ -133,4 +431,6 @@ int main() {
     cout << "Size of C: " << C << endl;
     cout << "Value of t: " << t << endl;
 }
-*/
\ No newline at end of file
+*/
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef FITNESSCACHE_CPP
+#define FITNESSCACHE_CPP
+
+#include <iostream>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include "rng.cpp"
+using namespace std;
+
+// Zobrist hashing of seed sets: the hash of a set is the XOR of a random key per node, so adding or removing a node
+// updates it in O(1) (hash ^ zobristKey(v)) and the same set always gets the same hash, whatever the order of the moves
+inline uint64_t zobristKey(int v) {
+    return splitMix64(splitMix64(v) ^ 0x5A0B1D75A0B1D75AULL);
+}
+
+template <class Container>
+uint64_t zobristHash(const Container& S) {
+    uint64_t h = 0;
+    for (int v : S) h ^= zobristKey(v);
+    return h;
+}
+
+// Bounded cache of the fitness (spread) of seed sets, keyed by their Zobrist hash and size, which evicts the least
+// recently used set when it is full. A capacity of 0 disables it
+// With Monte Carlo estimates a set that comes back gets the estimate it had, instead of a fresh noisy one
+struct FitnessCache {
+    struct Entry {
+        uint64_t hash;
+        int size;
+        int value;
+    };
+
+    size_t capacity;
+    // Most recently used first
+    list<Entry> entries;
+    unordered_map<uint64_t, list<Entry>::iterator> index;
+    long long hits, misses, evictions;
+
+    FitnessCache(size_t capacity = 0) : capacity(capacity), hits(0), misses(0), evictions(0) {
+        index.reserve(capacity);
+    }
+
+    // Fitness of the set with the given hash and size, computed with compute() if it is not in the cache
+    template <class F>
+    int get(uint64_t hash, int size, F compute) {
+        if (capacity == 0) return compute();
+        auto it = index.find(hash);
+        if (it != index.end() and it->second->size == size) {
+            ++hits;
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->value;
+        }
+        ++misses;
+        int value = compute();
+        if (it != index.end()) {
+            // Same hash and different size: keep the newest
+            entries.erase(it->second);
+            index.erase(it);
+        }
+        else if (entries.size() == capacity) {
+            index.erase(entries.back().hash);
+            entries.pop_back();
+            ++evictions;
+        }
+        entries.push_front({hash, size, value});
+        index[hash] = entries.begin();
+        return value;
+    }
+
+    void add(const FitnessCache& other) {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+    }
+
+    void printStats(const string& name) const {
+        if (capacity == 0) return;
+        cerr << name << ": " << hits << " hits, " << misses << " misses ("
+             << (hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0) << "% hit rate), " << evictions << " evictions" << endl;
+    }
+};
+
+#endif
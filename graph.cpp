@@ -0,0 +1,475 @@
+#ifndef GRAPH_CPP
+#define GRAPH_CPP
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <utility>
+#include <string>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace std;
+
+// Vertex orderings that can be applied after reading the graph
+// NATURAL keeps the ids of the input file, DEGREE puts hubs first and RCM (reverse Cuthill-McKee)
+// numbers vertices in BFS order so that neighbourhoods end up close in memory
+enum VertexOrder { NATURAL, DEGREE, RCM };
+
+// Contiguous range over the neighbours of a vertex
+struct Neighbours {
+    const int* first;
+    const int* last;
+
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+    int size() const { return last - first; }
+    int operator[](int i) const { return first[i]; }
+};
+
+// Arrays of a graph built in memory
+struct GraphArrays {
+    vector<int> offset;
+    vector<int> adj;
+    vector<int> originalId;
+};
+
+// Identity of a set of graph arrays, never reused (0 is the empty graph)
+uint64_t newGraphId() {
+    static atomic<uint64_t> lastId(0);
+    return ++lastId;
+}
+
+// Struct for undirected graph stored in compressed sparse row format:
+// the neighbours of v are adj[offset[v]] ... adj[offset[v+1] - 1]
+// The arrays are read-only and may live either in memory or in a mapped cache file (see loadGraphCache)
+struct Graph {
+    int numNodes;
+    int numEdges;
+    const int* offset;
+    const int* adj;
+    // Label of every vertex in the input file (0-based), so results can be reported with the original ids
+    const int* originalId;
+    // Keeps the arrays alive, copies of the graph share them
+    shared_ptr<const void> storage;
+    // Identity of the arrays, shared by the copies: the per-thread caches of derived data are keyed on it, since the
+    // address of freed arrays can be reused by a different graph
+    uint64_t id;
+
+    Graph() : numNodes(0), numEdges(0), offset(nullptr), adj(nullptr), originalId(nullptr), id(0) {}
+
+    // Take ownership of arrays built in memory
+    Graph(int n, int m, shared_ptr<GraphArrays> arrays) : numNodes(n), numEdges(m) {
+        offset = arrays->offset.data();
+        adj = arrays->adj.data();
+        originalId = arrays->originalId.data();
+        storage = arrays;
+        id = newGraphId();
+    }
+
+    int degree(int v) const {
+        return offset[v + 1] - offset[v];
+    }
+
+    Neighbours neighbours(int v) const {
+        return {adj + offset[v], adj + offset[v + 1]};
+    }
+
+    void printEdges() const {
+        for (int vertex = 0; vertex < numNodes; ++vertex) {
+            for (int neighbour : neighbours(vertex)) cout << originalId[vertex] << " -> " << originalId[neighbour] << endl;
+        }
+    }
+};
+
+// Build the CSR graph from an edge list (0-based endpoints) with a counting pass
+// Neighbours keep the order in which the edges were given, as the old adjacency lists did
+Graph buildGraph(int n, const vector<pair<int, int> >& edges) {
+    auto A = make_shared<GraphArrays>();
+    A->offset.assign(n + 1, 0);
+    for (const pair<int, int>& e : edges) {
+        ++A->offset[e.first + 1];
+        ++A->offset[e.second + 1];
+    }
+    for (int v = 0; v < n; ++v) A->offset[v + 1] += A->offset[v];
+
+    A->adj.resize(A->offset[n]);
+    vector<int> pos(A->offset.begin(), A->offset.end() - 1);
+    for (const pair<int, int>& e : edges) {
+        A->adj[pos[e.first]++] = e.second;
+        A->adj[pos[e.second]++] = e.first;
+    }
+
+    A->originalId.resize(n);
+    for (int v = 0; v < n; ++v) A->originalId[v] = v;
+    return Graph(n, edges.size(), A);
+}
+
+// Compute the new position of every vertex for the given ordering (order[k] = old id of the k-th vertex)
+vector<int> computeOrder(const Graph& G, VertexOrder ord) {
+    int n = G.numNodes;
+    vector<int> order(n);
+    for (int v = 0; v < n; ++v) order[v] = v;
+
+    if (ord == DEGREE) {
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return G.degree(a) > G.degree(b);
+        });
+    }
+    else if (ord == RCM) {
+        // Start every component from a vertex of minimum degree and visit neighbours by increasing degree
+        vector<int> byDegree(order);
+        stable_sort(byDegree.begin(), byDegree.end(), [&](int a, int b) {
+            return G.degree(a) < G.degree(b);
+        });
+        vector<bool> visited(n, false);
+        vector<int> nexts;
+        int k = 0;
+        for (int root : byDegree) {
+            if (visited[root]) continue;
+            visited[root] = true;
+            order[k++] = root;
+            for (int head = k - 1; head < k; ++head) {
+                int v = order[head];
+                nexts.clear();
+                for (int neighbour : G.neighbours(v)) {
+                    if (not visited[neighbour]) {
+                        visited[neighbour] = true;
+                        nexts.push_back(neighbour);
+                    }
+                }
+                stable_sort(nexts.begin(), nexts.end(), [&](int a, int b) {
+                    return G.degree(a) < G.degree(b);
+                });
+                for (int u : nexts) order[k++] = u;
+            }
+        }
+        reverse(order.begin(), order.end());
+    }
+    return order;
+}
+
+// Relabel the vertices of G following the given ordering, keeping track of the original ids
+Graph relabelGraph(const Graph& G, VertexOrder ord) {
+    if (ord == NATURAL) return G;
+
+    int n = G.numNodes;
+    vector<int> order = computeOrder(G, ord);
+    vector<int> newId(n);
+    for (int k = 0; k < n; ++k) newId[order[k]] = k;
+
+    auto A = make_shared<GraphArrays>();
+    A->offset.assign(n + 1, 0);
+    A->adj.resize(G.offset[n]);
+    A->originalId.resize(n);
+    for (int k = 0; k < n; ++k) {
+        int v = order[k];
+        A->originalId[k] = G.originalId[v];
+        A->offset[k + 1] = A->offset[k] + G.degree(v);
+        int pos = A->offset[k];
+        for (int neighbour : G.neighbours(v)) A->adj[pos++] = newId[neighbour];
+    }
+    return Graph(n, G.numEdges, A);
+}
+
+// Read a Graph (adapted for dimacs files) through cin
+Graph readGraphStream() {
+    char p;
+    string edge;
+    cin >> p >> edge;
+    int n, m;
+    cin >> n >> m;
+
+    vector<pair<int, int> > edges(m);
+
+    char e;
+    int u, v;
+    for (int i = 0; i < m; ++i) {
+        cin >> e >> u >> v;
+        edges[i] = make_pair(u - 1, v - 1);
+    }
+
+    return buildGraph(n, edges);
+}
+
+// Parse a non negative integer starting at c, leaving c after its last digit
+inline int parseInt(const char*& c, const char* end) {
+    while (c < end and (*c < '0' or *c > '9')) ++c;
+    int x = 0;
+    while (c < end and *c >= '0' and *c <= '9') x = 10 * x + (*c++ - '0');
+    return x;
+}
+
+// Parse the "e u v" lines of [first, last), which must start at the beginning of a line
+void parseEdges(const char* first, const char* last, vector<pair<int, int> >& edges) {
+    const char* c = first;
+    while (c < last) {
+        if (*c == 'e') {
+            ++c;
+            int u = parseInt(c, last);
+            int v = parseInt(c, last);
+            edges.push_back(make_pair(u - 1, v - 1));
+        }
+        // Skip to the next line (comments and any other line are ignored)
+        while (c < last and *c != '\n') ++c;
+        ++c;
+    }
+}
+
+// Read a Graph from a dimacs file already opened as fd: the file is memory mapped, split in line-aligned
+// chunks parsed by different threads, and the CSR is built with a single counting pass over the chunks
+// Returns false if fd can not be mapped (e.g. it is a pipe)
+bool readGraphMapped(int fd, Graph& G) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 or not S_ISREG(st.st_mode) or st.st_size == 0) return false;
+    size_t size = st.st_size;
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) return false;
+    madvise(addr, size, MADV_SEQUENTIAL);
+    const char* data = (const char*) addr;
+    const char* end = data + size;
+
+    // Header "p edge n m", possibly preceded by comment lines
+    const char* c = data;
+    while (c < end and *c != 'p') {
+        while (c < end and *c != '\n') ++c;
+        ++c;
+    }
+    if (c >= end) {
+        cerr << "Missing 'p edge n m' line in the input graph" << endl;
+        exit(1);
+    }
+    int n = parseInt(c, end);
+    int m = parseInt(c, end);
+    while (c < end and *c != '\n') ++c;
+    if (c < end) ++c;
+
+    // Split the body in chunks of at least 1 MB that begin and end at line boundaries
+    const size_t minChunk = 1 << 20;
+    size_t numChunks = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), (end - c) / minChunk));
+    vector<const char*> bounds(numChunks + 1, end);
+    bounds[0] = c;
+    for (size_t k = 1; k < numChunks; ++k) {
+        const char* b = c + (end - c) * k / numChunks;
+        while (b < end and *(b - 1) != '\n') ++b;
+        bounds[k] = max(b, bounds[k - 1]);
+    }
+
+    // Parse every chunk and count the degrees it contributes
+    vector<vector<pair<int, int> > > edges(numChunks);
+    vector<vector<int> > degree(numChunks);
+    auto parseChunk = [&](size_t k) {
+        edges[k].reserve((size_t) m / numChunks + 1);
+        parseEdges(bounds[k], bounds[k + 1], edges[k]);
+        degree[k].assign(n, 0);
+        for (const pair<int, int>& e : edges[k]) {
+            ++degree[k][e.first];
+            ++degree[k][e.second];
+        }
+    };
+    vector<thread> workers;
+    for (size_t k = 1; k < numChunks; ++k) workers.push_back(thread(parseChunk, k));
+    parseChunk(0);
+    for (thread& w : workers) w.join();
+    munmap(addr, size);
+
+    auto A = make_shared<GraphArrays>();
+    int numEdges = 0;
+    A->offset.assign(n + 1, 0);
+    for (size_t k = 0; k < numChunks; ++k) {
+        numEdges += edges[k].size();
+        for (int v = 0; v < n; ++v) A->offset[v + 1] += degree[k][v];
+    }
+    for (int v = 0; v < n; ++v) A->offset[v + 1] += A->offset[v];
+
+    // Scatter the chunks in file order, so neighbours are in the same order readGraphStream() gives
+    A->adj.resize(A->offset[n]);
+    vector<int> pos(A->offset.begin(), A->offset.end() - 1);
+    for (size_t k = 0; k < numChunks; ++k) {
+        for (const pair<int, int>& e : edges[k]) {
+            A->adj[pos[e.first]++] = e.second;
+            A->adj[pos[e.second]++] = e.first;
+        }
+    }
+
+    A->originalId.resize(n);
+    for (int v = 0; v < n; ++v) A->originalId[v] = v;
+    G = Graph(n, numEdges, A);
+    return true;
+}
+
+// Binary cache of a relabelled graph, stored next to the dimacs file as <file>.<order>.csr
+// Layout: GraphCacheHeader followed by the int32 arrays offset[n+1], adj[2m] and originalId[n]
+const char graphCacheMagic[8] = {'T', 'S', 'S', 'C', 'S', 'R', 0, 0};
+const uint32_t graphCacheVersion = 2;
+
+struct GraphCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t order;
+    int64_t numNodes;
+    int64_t numEdges;
+    // Size and modification time of the dimacs file the cache was built from
+    int64_t sourceSize;
+    int64_t sourceMtime;
+    // Hash of the fields above and of offset, checked on every load, and hash of all the arrays, checked only when
+    // verifyGraphCache is set: a cache hit must not cost a pass over the whole file
+    uint64_t checksum;
+    uint64_t dataChecksum;
+};
+
+// Check the hash of all the arrays of a cache file when it is loaded (set with TSS_VERIFY_CACHE)
+bool verifyGraphCache = getenv("TSS_VERIFY_CACHE") != nullptr;
+
+const char* orderName(VertexOrder ord) {
+    if (ord == DEGREE) return "degree";
+    if (ord == RCM) return "rcm";
+    return "natural";
+}
+
+// FNV-1a hash, continuing from h, taken over 8-byte words (and the bytes of the tail)
+uint64_t checksum(const void* data, size_t bytes, uint64_t h = 1469598103934665603ULL) {
+    const unsigned char* c = (const unsigned char*) data;
+    size_t words = bytes / 8;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t w;
+        memcpy(&w, c + 8 * i, 8);
+        h ^= w;
+        h *= 1099511628211ULL;
+    }
+    for (size_t i = 8 * words; i < bytes; ++i) {
+        h ^= c[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Hash of the header fields (up to the checksums) and of the offsets of a cache file
+uint64_t headerChecksum(const GraphCacheHeader& h, const int* offset) {
+    return checksum(offset, (h.numNodes + 1) * sizeof(int), checksum(&h, offsetof(GraphCacheHeader, checksum)));
+}
+
+// Hash of all the arrays of G
+uint64_t dataChecksum(const Graph& G) {
+    uint64_t h = checksum(G.offset, (G.numNodes + 1) * sizeof(int));
+    h = checksum(G.adj, 2 * (size_t) G.numEdges * sizeof(int), h);
+    return checksum(G.originalId, G.numNodes * sizeof(int), h);
+}
+
+// Map a cache file read-only; fails if it is missing, older than the dimacs file described by source, or its header
+// or offsets are corrupted (or any array, with verifyGraphCache)
+bool loadGraphCache(const string& path, const struct stat& source, VertexOrder ord, Graph& G) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 or (size_t) st.st_size < sizeof(GraphCacheHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return false;
+    // The mapping is released when the last copy of the graph goes away
+    shared_ptr<const void> mapping(addr, [size](const void* a) { munmap((void*) a, size); });
+
+    const GraphCacheHeader* h = (const GraphCacheHeader*) addr;
+    size_t n = h->numNodes;
+    size_t arrays = (n + 1 + 2 * h->numEdges + n) * sizeof(int);
+    if (memcmp(h->magic, graphCacheMagic, 8) != 0 or h->version != graphCacheVersion or h->order != (uint32_t) ord
+        or h->sourceSize != source.st_size or h->sourceMtime != source.st_mtime
+        or size != sizeof(GraphCacheHeader) + arrays) return false;
+
+    const int* data = (const int*) (h + 1);
+    if (headerChecksum(*h, data) != h->checksum) return false;
+
+    G.numNodes = n;
+    G.numEdges = h->numEdges;
+    G.offset = data;
+    G.adj = G.offset + n + 1;
+    G.originalId = G.adj + 2 * h->numEdges;
+    G.storage = mapping;
+    G.id = newGraphId();
+    return not verifyGraphCache or dataChecksum(G) == h->dataChecksum;
+}
+
+// Write the cache file atomically (through a temporary file), ignoring failures such as read-only directories
+void writeGraphCache(const string& path, const struct stat& source, VertexOrder ord, const Graph& G) {
+    GraphCacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, graphCacheMagic, 8);
+    h.version = graphCacheVersion;
+    h.order = ord;
+    h.numNodes = G.numNodes;
+    h.numEdges = G.numEdges;
+    h.sourceSize = source.st_size;
+    h.sourceMtime = source.st_mtime;
+    h.checksum = headerChecksum(h, G.offset);
+    h.dataChecksum = dataChecksum(G);
+
+    string tmp = path + "." + to_string(getpid());
+    FILE* out = fopen(tmp.c_str(), "wb");
+    if (out == nullptr) return;
+    bool ok = fwrite(&h, sizeof(h), 1, out) == 1
+        and fwrite(G.offset, sizeof(int), G.numNodes + 1, out) == (size_t) G.numNodes + 1
+        and fwrite(G.adj, sizeof(int), 2 * (size_t) G.numEdges, out) == 2 * (size_t) G.numEdges
+        and fwrite(G.originalId, sizeof(int), G.numNodes, out) == (size_t) G.numNodes;
+    ok = fclose(out) == 0 and ok;
+    if (not ok or rename(tmp.c_str(), path.c_str()) != 0) unlink(tmp.c_str());
+}
+
+// Load a Graph (adapted for dimacs files) from fd, whose path is given when it is known
+// Regular files are served from their binary cache when it is up to date; otherwise they are parsed
+// with readGraphMapped() and the cache is written for the next runs. Pipes are read through cin
+Graph loadGraph(int fd, const string& path, VertexOrder ord) {
+    auto start = chrono::high_resolution_clock::now();
+    struct stat st;
+    bool regular = fstat(fd, &st) == 0 and S_ISREG(st.st_mode);
+    string cachePath = path + "." + orderName(ord) + ".csr";
+
+    Graph G;
+    bool cached = regular and not path.empty() and loadGraphCache(cachePath, st, ord, G);
+    if (not cached) {
+        if (not (regular and readGraphMapped(fd, G))) G = readGraphStream();
+        G = relabelGraph(G, ord);
+        if (regular and not path.empty()) writeGraphCache(cachePath, st, ord, G);
+    }
+
+    double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    cerr << "Graph loaded" << (cached ? " from cache" : "") << ": " << G.numNodes << " nodes and " << G.numEdges << " edges in " << seconds << " s";
+    if (regular) cerr << " (" << st.st_size / 1e6 / seconds << " MB/s, " << G.numEdges / seconds << " edges/s)";
+    cerr << endl;
+    return G;
+}
+
+// Read a Graph (adapted for dimacs files) from the standard input
+Graph readGraph(VertexOrder ord = NATURAL) {
+    char path[4096];
+    ssize_t len = readlink("/proc/self/fd/0", path, sizeof(path) - 1);
+    return loadGraph(0, len > 0 ? string(path, len) : "", ord);
+}
+
+// Read a Graph (adapted for dimacs files) from the given file
+Graph readGraph(const string& path, VertexOrder ord = NATURAL) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Can not open " << path << endl;
+        exit(1);
+    }
+    Graph G = loadGraph(fd, path, ord);
+    close(fd);
+    return G;
+}
+
+#endif
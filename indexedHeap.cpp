@@ -0,0 +1,80 @@
+#ifndef INDEXEDHEAP_CPP
+#define INDEXEDHEAP_CPP
+
+#include <vector>
+using namespace std;
+
+// Max-heap of nodes keyed by their (possibly stale) marginal gain, whose keys can be updated in place
+// Ties are broken by the smallest node id
+struct IndexedHeap {
+    vector<int> heap;
+    vector<int> position;
+    vector<double> key;
+
+    IndexedHeap(int n) : position(n, -1), key(n, 0) {}
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    int top() const {
+        return heap[0];
+    }
+
+    bool above(int u, int v) const {
+        return key[u] > key[v] or (key[u] == key[v] and u < v);
+    }
+
+    void place(int i, int v) {
+        heap[i] = v;
+        position[v] = i;
+    }
+
+    void siftUp(int i) {
+        int v = heap[i];
+        while (i > 0 and above(v, heap[(i - 1) / 2])) {
+            place(i, heap[(i - 1) / 2]);
+            i = (i - 1) / 2;
+        }
+        place(i, v);
+    }
+
+    void siftDown(int i) {
+        int v = heap[i];
+        int n = heap.size();
+        while (2 * i + 1 < n) {
+            int c = 2 * i + 1;
+            if (c + 1 < n and above(heap[c + 1], heap[c])) ++c;
+            if (not above(heap[c], v)) break;
+            place(i, heap[c]);
+            i = c;
+        }
+        place(i, v);
+    }
+
+    void push(int v, double k) {
+        key[v] = k;
+        heap.push_back(v);
+        siftUp(heap.size() - 1);
+    }
+
+    void pop() {
+        int v = heap[0];
+        position[v] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (not heap.empty()) {
+            place(0, last);
+            siftDown(0);
+        }
+    }
+
+    void update(int v, double k) {
+        double old = key[v];
+        key[v] = k;
+        if (k > old) siftUp(position[v]);
+        else siftDown(position[v]);
+    }
+};
+
+#endif
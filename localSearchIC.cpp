@@ -6,206 +6,231 @@
 #include <set>
 #include <ctime>
 #include <chrono>
+#include "monteCarloIC.cpp"
+#include "fitnessCache.cpp"
 using namespace std;
 using namespace std::chrono;
-typedef pair<int, int> pii;
 
-// Struct for undirected graph
-struct Graph {
-    int numNodes;
-    vector<vector<int> > adjList;
-
-    // Graph constructor:
-    Graph(int n) {
-        numNodes = n;
-        adjList.resize(n);
-    }
-
-    Graph() {
-    }
-
-    void addEdge(int u, int v) {
-        adjList[u].push_back(v);
-        adjList[v].push_back(u);
-    }
-
-    void printEdges() {
-        for (int vertex = 0; vertex < adjList.size(); ++vertex) {
-            for (int neighbour : adjList[vertex]) cout << vertex << " -> " << neighbour << endl;
-        }
-    }
-};
-
-// Simulate IC difusion process
-int difusioIC(const Graph& G, double& p, set<int>& S) {
-    // Set of influenced nodes
-    vector<bool> influenced(G.numNodes, false);
-    // Set of active nodes (nodes able to activate other nodes per iteration)
-    queue<int> active;
-
-    int n_influenced = 0;
+// Local search algorithm for first improvement, based on number of nodes heuristics at every subset S
+// We pick the first successor state which reduces S by 1 (obviously) and the state is still a solution
+// Spreads go through a fitness cache of cacheSize sets keyed by their Zobrist hash: after a removal, the spread of the
+// new S was just computed and is not simulated again
+// With sequential, a candidate only needs to know whether its spread reaches max(spread of S, target), so it is
+// evaluated by monteCarloAtLeast, which stops as soon as the answer is settled
+void localSearch(const Graph& G, double p, SeedSet& S, int nMonteCarlo, double optimality, size_t cacheSize = 0,
+                 bool sequential = false) {
+    if (icComponents != nullptr) return componentLocalSearch(*icComponents, S, optimality);
+    FitnessCache cache(cacheSize);
+    uint64_t hash = zobristHash(S);
+    bool improvement = true;
     
-    int t = 0;
-
-    // Activate initial set of nodes
-    for (int vertex : S) {
-        influenced[vertex] = true;
-        ++n_influenced;
-        active.push(vertex);
-    }
-
-    // Continue untill no more active nodes
-    while (not active.empty()) {
-        ++t;
-        int numCurrentActive = active.size();
-        // Process all active nodes in the current layer
-        for (int i = 0; i < numCurrentActive; ++i) {
-            int v = active.front();
-            active.pop();
-            // Check neighbours of v
-            for (int j = 0; j < G.adjList[v].size(); ++j) {
-                int neighbour = G.adjList[v][j];
-                 // If neighbor is not already active, try to activate it
-                if (not influenced[neighbour]) {
-                    double r = (double) rand() / RAND_MAX;
-                    if (r < p) {
-                        influenced[neighbour] = true;
-                        ++n_influenced;
-                        active.push(neighbour);
-                    }
-                }
+    while (improvement) {
+        improvement = false;
+        int currentInfluence = cache.get(hash, S.size(), [&] { return monteCarlo(G, p, S, nMonteCarlo); });
+        for (size_t i = 0; i < S.size(); ++i) {
+            // Try S - {node} in place, and put node back where it was if it is not a solution
+            int node = S[i];
+            S.erase(node);
+            uint64_t tempHash = hash ^ zobristKey(node);
+            // int currentInfluence = monteCarlo(G, p, S, nMonteCarlo);
+            bool improvement_found;
+            if (sequential) {
+                double threshold = max<double>(currentInfluence, optimality * G.numNodes);
+                improvement_found = monteCarloAtLeast(G, p, S, threshold, nMonteCarlo, numMonteCarloCalls++).reached;
+            }
+            else {
+                int tempInfluence = cache.get(tempHash, S.size(), [&] { return monteCarlo(G, p, S, nMonteCarlo); });
+                improvement_found = tempInfluence >= currentInfluence && tempInfluence >= optimality * G.numNodes;
             }
+            
+            if (improvement_found) {
+                improvement = true;
+                hash = tempHash;
+                break;
+            }
+            S.restore(node, i);
         }
     }
-
-    // Count all influenced nodes by S
-/*     int count = 0;
-    for (int i = 0; i < influenced.size(); ++i) if (influenced[i]) ++count;
-    return count; */
-    return n_influenced;
+    cache.printStats("Fitness cache");
+    printSequentialStats();
 }
 
-// Comparer for the priority queue
-struct Compare {
-    bool operator()(const pii& a, const pii& b) {
-        return a.second < b.second;
-    }
+// Move of the best improvement local search: remove the seeds out (one, or two for a swap) and add the node in
+// (-1 for a removal); total is the number of nodes influenced by the resulting set over the worlds of the round
+struct LocalSearchMove {
+    int out[2];
+    int in;
+    long long total;
 };
 
-// Simulate the IC model several times for more accuracy
-int monteCarlo(const Graph& G, double p, set<int>& S, int iterations) {
-    int sum = 0;
-    for (int i = 0; i < iterations; ++i) {
-        sum += difusioIC(G, p, S);
+void applyMove(SeedSet& S, ComponentCover& cover, const LocalSearchMove& m) {
+    for (int v : m.out) {
+        if (v == -1) continue;
+        S.erase(v);
+        cover.remove(v);
+    }
+    if (m.in != -1) {
+        S.insert(m.in);
+        cover.add(m.in);
     }
-    return sum / iterations;
 }
 
-// Greedy algorithm to select the minimum influence set
-set<int> greedyMinInfluenceSet(const Graph& G, double p, int nMonteCarlo, double optimality) {
-    set<int> S;
-    vector<pair<int, int> > gain;
-    int numNodes = G.numNodes;
-    priority_queue<pii, vector<pii>, Compare> Q;
-
-    // Calcular la ganancia marginal de todos los nodos e ir insertando en la cola de prioridad
-    for (int i = 0; i < numNodes; ++i) {
-        set<int> single_node_set;
-        single_node_set.insert(i);
-        int gain_val = monteCarlo(G, p, single_node_set, nMonteCarlo);
-        Q.push(make_pair(i, gain_val));
+void undoMove(SeedSet& S, ComponentCover& cover, const LocalSearchMove& m) {
+    if (m.in != -1) {
+        S.erase(m.in);
+        cover.remove(m.in);
     }
-
-    // Añadir el primer nodo de la cola Q a S y quitarlo de la cola
-    S.insert(Q.top().first);
-    Q.pop();
-
-    // Calcular la difusión de S
-    int diffusion = monteCarlo(G, p, S, nMonteCarlo);
-
-    // Mientras la cola Q no esté vacía y difusio(G, p, S) != |V|
-    while (!Q.empty()) {
-        // If current difussion is OK, break
-        if (diffusion >= optimality * numNodes) break;
-
-        int current_node = Q.top().first;
-
-        // Añadir el primer nodo de la cola Q a S y quitarlo de la cola, si el nodo no está en S
-        if (S.find(current_node) == S.end()) {
-            S.insert(current_node);
-            diffusion = monteCarlo(G, p, S, nMonteCarlo);
-        }
-        Q.pop();
+    for (int v : m.out) {
+        if (v == -1) continue;
+        S.insert(v);
+        cover.add(v);
     }
-
-    return S;
 }
 
-// Local search algorithm for first improvement, based on number of nodes heuristics at every subset S
-// We pick the first successor state which reduces S by 1 (obviously) and the state is still a solution
-void localSearch(const Graph& G, double p, set<int>& S, int nMonteCarlo, double optimality) {
-    bool improvement = true;
-    
-    while (improvement) {
-        improvement = false;
-        int currentInfluence = monteCarlo(G, p, S, nMonteCarlo);
-        for (int node : S) {
-            set<int> tempS(S);
-            tempS.erase(node);
-            // int currentInfluence = monteCarlo(G, p, S, nMonteCarlo);
-            int tempInfluence = monteCarlo(G, p, tempS, nMonteCarlo);
-            
-            if (tempInfluence >= currentInfluence && tempInfluence >= optimality * G.numNodes) {
-                improvement = true;
-                S = tempS;
-                break;
+// Moves around S: every single removal, and 2-for-1 swaps where a node c adjacent to two or more seeds replaces its
+// two seed neighbours of smallest degree, the ones most likely to be reached from c. Only the maxSwaps nodes with
+// the most seed neighbours are tried
+vector<LocalSearchMove> neighbourhoodMoves(const Graph& G, const SeedSet& S, int maxSwaps) {
+    vector<LocalSearchMove> moves;
+    for (int v : S) moves.push_back({{v, -1}, -1, 0});
+    vector<int> seedNeighbours(G.numNodes, 0);
+    vector<int> candidates;
+    for (int v : S) {
+        for (int c : G.neighbours(v)) {
+            if (not S.contains(c) and seedNeighbours[c]++ == 1) candidates.push_back(c);
+        }
+    }
+    sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+        return seedNeighbours[a] != seedNeighbours[b] ? seedNeighbours[a] > seedNeighbours[b] : a < b;
+    });
+    if ((int) candidates.size() > maxSwaps) candidates.resize(maxSwaps);
+    for (int c : candidates) {
+        int a = -1, b = -1;
+        for (int v : G.neighbours(c)) {
+            if (not S.contains(v)) continue;
+            if (a == -1 or G.degree(v) < G.degree(a)) {
+                b = a;
+                a = v;
             }
+            else if (b == -1 or G.degree(v) < G.degree(b)) b = v;
         }
+        moves.push_back({{a, b}, c, 0});
     }
+    return moves;
 }
 
-
-// Read a Graph (adapted for dimacs files)
-Graph readGraph() {
-    char p;
-    string edge;
-    cin >> p >> edge;
-    int n, m;
-    cin >> n >> m;
-
-    Graph G(n);
-
-    char e;
-    int u, v;
-    for (int i = 0; i < m; ++i) {
-        cin >> e >> u >> v;
-        G.addEdge(u-1, v-1);
+// Best improvement local search: every round samples nMonteCarlo live-edge worlds, shared by all the candidate moves
+// (common random numbers), and condenses them into their components (see componentsIC.cpp), so scoring a move is a
+// lookup of the components of its nodes instead of a Monte Carlo evaluation; the moves are scored in parallel
+// A move is valid if S' keeps the spread of S and the target on the worlds of the round, or loses no node at all in
+// any of them (its seeds are redundant on the whole sample), so a sample where S misses the target by chance does not
+// stop the search. The valid ones are taken from the largest spread down, skipping those that share a node with a
+// move already taken, and each one is kept only if S is still valid with all the moves kept before it
+// Stops when a round has no valid move. If worlds are in use (see useWorlds) every round uses them instead of a
+// new sample
+void bestImprovementLocalSearch(const Graph& G, double p, SeedSet& S, int nMonteCarlo, double optimality, int maxSwaps) {
+    if (icComponents != nullptr) return componentLocalSearch(*icComponents, S, optimality);
+    LiveEdgeWorlds sample;
+    WorldComponents C;
+    if (icWorlds != nullptr) condenseWorlds(G, *icWorlds, C);
+    long long rounds = 0, scored = 0, applied = 0;
+    while (true) {
+        if (icWorlds == nullptr) {
+            sampleWorlds(G, p, nMonteCarlo, splitMix64(masterSeed ^ numMonteCarloCalls++), sample);
+            condenseWorlds(G, sample, C);
+        }
+        ComponentCover cover(C);
+        for (int v : S) cover.add(v);
+        int currentInfluence = cover.spread();
+        long long currentTotal = cover.total;
+        // Whether a set with the given total over the worlds can replace S
+        auto keeps = [&](long long total) {
+            int spread = total / C.numWorlds;
+            return total >= currentTotal or (spread >= currentInfluence && spread >= optimality * G.numNodes);
+        };
+
+        vector<LocalSearchMove> moves = neighbourhoodMoves(G, S, maxSwaps);
+        parallelFor(moves.size(), [&](int i) {
+            LocalSearchMove& m = moves[i];
+            m.total = m.in == -1 ? cover.total - cover.loss(m.out[0]) : cover.totalAfterSwap(m.out[0], m.out[1], m.in);
+        });
+        ++rounds;
+        scored += moves.size();
+
+        vector<LocalSearchMove> valid;
+        for (const LocalSearchMove& m : moves) {
+            if (keeps(m.total)) valid.push_back(m);
+        }
+        if (valid.empty()) break;
+        stable_sort(valid.begin(), valid.end(), [](const LocalSearchMove& a, const LocalSearchMove& b) { return a.total > b.total; });
+
+        vector<bool> used(G.numNodes, false);
+        for (const LocalSearchMove& m : valid) {
+            int nodes[3] = {m.out[0], m.out[1], m.in};
+            bool conflict = false;
+            for (int v : nodes) if (v != -1 and used[v]) conflict = true;
+            if (conflict) continue;
+            applyMove(S, cover, m);
+            if (keeps(cover.total)) {
+                for (int v : nodes) if (v != -1) used[v] = true;
+                ++applied;
+            }
+            else undoMove(S, cover, m);
+        }
     }
-
-    return G;
+    cerr << "Best improvement local search: " << rounds << " rounds, " << scored << " moves scored, " << applied
+         << " applied" << endl;
 }
 
+#ifndef TSS_NO_MAIN
 int main() {
     
-    // Generate random seed for proper random values
-    unsigned seed = chrono::high_resolution_clock::now().time_since_epoch().count();
-    srand(seed);
+    // Generate random seed for proper random values (set TSS_SEED to replay a run)
+    uint64_t seed = chooseSeed();
+    seedMonteCarlo(seed);
 
-    // Declare and read the graph G = (V, E)
-    Graph G = readGraph();
+    // Declare and read the graph G = (V, E) with the ids of the file. RCM lays neighbourhoods out contiguously in
+    // memory, but ties between nodes are broken on their ids, so it could change the seeds found
+    Graph G = readGraph(NATURAL);
 
     // Set the probability for the IC model
     double p = 0.5;
 
+    // Set the sampler of the IC simulations: BIT_PARALLEL and COIN_FLIP for high probabilities, GEOMETRIC for low ones
+    icSampler = BIT_PARALLEL;
+
     // Set MonteCarlo iterations i.e. number of times the simulation will be executed each time (more iterations -> slower but more accurate)
     int nMonteCarlo = 100;
 
+    // Evaluate every seed set on the same numWorlds sampled live-edge graphs instead of nMonteCarlo fresh simulations (0 to disable)
+    // They are saved to worldsFile, if it is not empty, and reused by the next runs with the same graph, p and seed
+    int numWorlds = 0;
+    string worldsFile = "";
+    if (numWorlds > 0) useWorlds(G, p, numWorlds, seed, worldsFile);
+
+    // Condense the worlds into their connected components, so that spreads and marginal gains are lookups instead of cascades
+    bool worldComponents = true;
+    if (numWorlds > 0 and worldComponents) useComponents(G);
+
     // Set the optimality, e. g. if optimality is 0.9 we will obtain a subset S whose MonteCarlo simulation warrantees covering 90% of the graph
     double optimality = 1;
 
+    // Use the best improvement local search, which scores all the removals and up to maxSwaps 2-for-1 swaps of
+    // every round at once on nMonteCarlo shared live-edge worlds, instead of the first improvement one
+    bool bestImprovement = true;
+    int maxSwaps = 100;
+
+    // Maximum number of seed sets whose spread is cached by the first improvement local search (0 to disable the cache)
+    size_t cacheSize = 1 << 16;
+
+    // Let the first improvement local search stop the simulations of a candidate as soon as it is known whether it
+    // reaches the target, wrong with probability at most sequentialDelta (0 to stop only when the answer is exact)
+    bool sequentialTests = true;
+    sequentialDelta = 0.05;
+
     auto start = high_resolution_clock::now();
     // Compute the subset with the greedy algorithm
-    set<int> S = greedyMinInfluenceSet(G, p, nMonteCarlo, optimality);
+    SeedSet S = greedyMinInfluenceSet(G, p, nMonteCarlo, optimality);
     auto stop = high_resolution_clock::now();
     auto duration = duration_cast<milliseconds>(stop - start);
 
@@ -214,10 +239,12 @@ int main() {
 
     start = high_resolution_clock::now();
     // Compute a localSearch approach from the greedy solution
-    localSearch(G, p, S, nMonteCarlo, optimality);
+    if (bestImprovement) bestImprovementLocalSearch(G, p, S, nMonteCarlo, optimality, maxSwaps);
+    else localSearch(G, p, S, nMonteCarlo, optimality, cacheSize, sequentialTests);
     stop = high_resolution_clock::now();
     duration = duration_cast<milliseconds>(stop - start);
 
     // Local search solution output
     cout << "Seed nodes selected by local search: " << S.size() << " in " << (double)duration.count()/1000 << " s" << endl;
 }
+#endif
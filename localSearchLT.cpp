@@ -1,75 +1,29 @@
 #include <algorithm>
 #include "difusioLT.cpp"
 
-Subset greedyMinInfluenceSet(Graph& G, double r) {
-    Subset S;
-    priority_queue<pair<int,int>> gain;
-
-    // Ordenar el vector de nodos por ganancia marginal
-    /*
-    for (int i = 0; i < G.numNodes; ++i) {
-            Subset s(1, i);
-            int t = 0;
-            gain.push(make_pair(simulateLT(G, r, s, t), i));
-    }*/
-    // Ordenar el vector de nodos por grado de aristas
-   
-    for (int i = 0; i < G.numNodes; ++i) {
-            gain.push(make_pair(G.adjList[i].size(), i));
-    }
-    
-    int t;
-    // Mientras aún haya nodos con ganancia marginal positiva y difusio(G, p, S) != |V|
-    while (!gain.empty()) {
-        int node = gain.top().second;
-        gain.pop();
-        while (G.influenced[node]) {
-            node = gain.top().second;
-            gain.pop();
-        }
-        S.push_back(node);
-        if (simulateLT(G, r, S, t) == G.numNodes) break;
-    }
-    return S;
-}
-
-
-// Local search algorithm for best improvement
-void localSearch(Graph& G, double r, Subset& S) {
-    bool improvement = true;
-    
-    while (improvement) {
-        improvement = false;
-        for (int node : S) {
-            Subset tempS(S);
-            tempS.erase(find(tempS.begin(), tempS.end(), node));
-            int t0,t1;
-            int currentInfluence = simulateLT(G, r, S, t0);
-            int tempInfluence = simulateLT(G, r, tempS, t1);
-            
-            if (tempInfluence == currentInfluence && tempS.size() < S.size()) {
-                improvement = true;
-                S = tempS;
-            }
-        }
-    }
+// Local search algorithm for first improvement: drop every seed whose removal keeps the same influence
+// Removing seeds only shrinks the influence of the others, so a single ordered pass reaches a local optimum
+void localSearch(LTGraph& G, double r, SeedSet& S) {
+    removeRedundantSeedsLT(G, r, S);
 }
 
+#ifndef TSS_NO_MAIN
 int main() {
     
     // Generate random seed for proper random values
     unsigned seed = chrono::high_resolution_clock::now().time_since_epoch().count();
     srand(seed);
 
-    // Declare and read the graph G = (V, E)
-    Graph G = readGraph();
+    // Declare and read the graph G = (V, E) with the ids of the file. RCM lays neighbourhoods out contiguously in
+    // memory, but ties between nodes are broken on their ids, so it could change the seeds found
+    LTGraph G = readGraph(NATURAL);
 
     // Set the probability for the IC model
     double r = 0.5;
 
     auto start = high_resolution_clock::now();
     // Compute the subset with the greedy algorithm
-    Subset S = greedyMinInfluenceSet(G, r);
+    SeedSet S = greedyMinInfluenceSet(G, r);
     auto stop = high_resolution_clock::now();
     auto duration = duration_cast<milliseconds>(stop - start);
 
@@ -84,4 +38,5 @@ int main() {
 
     // Local search solution output
     cout << "Seed nodes selected by local search: " << S.size() << " in " << (double)duration.count()/1000 << " s" << endl;
-}
\ No newline at end of file
+}
+#endif
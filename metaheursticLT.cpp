@@ -1,109 +1,129 @@
 #include <algorithm>
 #include <cmath>
 #include "difusioLT.cpp"
-
-// Greedy algorithm to select the minimum influence set
-Subset greedyMinInfluenceSet(Graph& G, double r) {
-    Subset S;
-    priority_queue<pair<int,int>> gain;
-
-    // Ordenar el vector de nodos por ganancia marginal
-    /*
-    for (int i = 0; i < G.numNodes; ++i) {
-            Subset s(1, i);
-            int t = 0;
-            gain.push(make_pair(simulateLT(G, r, s, t), i));
-    }*/
-    // Ordenar el vector de nodos por grado de aristas
-    
-    for (int i = 0; i < G.numNodes; ++i) {
-            gain.push(make_pair(G.adjList[i].size(), i));
+#include "tempering.cpp"
+#include "fitnessCache.cpp"
+
+// One chain of simulated annealing, with its own copy of the diffusion state: G keeps the diffusion of S, so only
+// the moves are evaluated. Chain k draws its moves from its own stream, so chains can run on different threads
+// The evaluations of the moves go through a fitness cache keyed by the Zobrist hash of S', updated with every move,
+// which holds the influence of S' when it covers the graph (and -1 for a removal that does not)
+struct LTAnnealingChain {
+    LTGraph G;
+    double p;
+    SeedSet S;
+    int influenceS;
+    double gain;
+    double T;
+    double alpha;
+    Rng rng;
+    int index;
+    BestRegister<SeedSet>* best;
+    uint64_t hash;
+    FitnessCache cache;
+
+    LTAnnealingChain(const LTGraph& G, double p, const SeedSet& S, double T, double alpha, uint64_t seed, int index, BestRegister<SeedSet>& best,
+                     size_t cacheSize)
+        : G(G), p(p), S(S), T(T), alpha(alpha), rng(seed, index), index(index), best(&best), hash(zobristHash(S)), cache(cacheSize) {
+        int t;
+        influenceS = simulateLT(this->G, p, this->S, t);
+        gain = influenceS / this->S.size();
     }
-    
-    int t;
 
-    // Mientras aún haya nodos con ganancia marginal positiva y difusio(G, p, S) != |V|
-    while (!gain.empty()) {
-        int node = gain.top().second;
-        gain.pop();
-        while (G.influenced[node]) {
-            node = gain.top().second;
-            gain.pop();
-        }
-        S.push_back(node);
-        if (simulateLT(G, r, S, t) == G.numNodes) break;
-    }
-    return S;
-}
-
-// Simulated Annealing algorithm based on gain per node heuristics at every subset S, in order to minimize the number of nodes
-Subset simulatedAnnealing(Graph& G, double p, Subset& S, int maxIter, double T, double alpha) {
-    
-    Subset bestSolution = S;
-    int t;
-    double bestGain = simulateLT(G, p, S, t) / S.size();
-
-    for (int iter = 0; iter < maxIter && T > 0; ++iter) {
+    void step() {
+        if (T <= 0) return;
         // Generate random neighbor solution S' erasing or adding a random node
-        bool borrar = (double)rand() / RAND_MAX <= 0.75;
-        Subset S_prime = S;
+        bool borrar = rng.uniform() <= 0.75;
         int random_node;
+        double propagation;
         if (borrar) {
-            random_node = S[rand() % S.size()];
-            S_prime.erase(find(S_prime.begin(), S_prime.end(), random_node));
+            random_node = S[rng.below(S.size())];
+            // Removing a node can only keep the influence of S if it is redundant
+            propagation = cache.get(hash ^ zobristKey(random_node), S.size() - 1, [&] {
+                return redundantSeedLT(G, p, S, random_node) ? influenceS : -1;
+            });
         } else {
-            random_node =  rand() % G.numNodes;
-            while(find(S.begin(), S.end(), random_node)!=S.end()) random_node =  rand() % G.numNodes;
-            S_prime.push_back(random_node);
+            random_node = rng.below(G.numNodes);
+            while(S.contains(random_node)) random_node = rng.below(G.numNodes);
+            propagation = cache.get(hash ^ zobristKey(random_node), S.size() + 1, [&] {
+                return influenceWithSeedLT(G, p, random_node, G.numNodes);
+            });
         }
+        int sizeS_prime = borrar ? S.size() - 1 : S.size() + 1;
 
         // Calculate gains per node for S and S'
-        double gain_S;
-        double propagation = simulateLT(G, p, S_prime, t);
-        //cout << iter << "\t"<<S_prime.size() << endl;
-        if (propagation != G.numNodes) continue;
+        if (propagation != G.numNodes) return;
 
-        if (iter == 0) gain_S = bestGain;
-        else gain_S = simulateLT(G, p, S, t) / S.size();
-        double gain_S_prime = propagation / S_prime.size();
+        double gain_S = influenceS / S.size();
+        double gain_S_prime = propagation / sizeS_prime;
 
         // Calculate acceptance probability
         double delta = gain_S_prime - gain_S;
         double prob = exp(delta / T);
 
         // If S' is better or accepted with probability, update S
-        
-        if (delta > 0 or (double)rand() / RAND_MAX < prob) {
-            S = S_prime;
-            if (gain_S_prime > bestGain) {
-                //cout << "Millora en iteració "<< iter << ": Tamany del conjunt:"<<S.size() << endl;
-                bestSolution = S_prime;
-                bestGain = gain_S_prime;
+        if (delta > 0 or rng.uniform() < prob) {
+            if (borrar) {
+                // S' has the same influence as S, so the diffusion in G stays valid
+                S.erase(random_node);
+            }
+            else {
+                S.insert(random_node);
+                addSeedLT(G, p, random_node);
             }
+            hash ^= zobristKey(random_node);
+            influenceS = propagation;
+            gain = gain_S_prime;
+            best->offer(S, gain_S_prime, index);
         }
 
         // Decrease temperature
         T *= alpha;
     }
+};
 
-    return bestSolution;
+// Simulated Annealing algorithm based on gain per node heuristics at every subset S, in order to minimize the number of nodes
+// With several chains it runs parallel tempering (see tempering.cpp): the chains start at temperatures spread between
+// T and the final one, exchange them every exchangeEvery iterations and share the best solution
+// Every chain caches the evaluations of up to cacheSize sets
+// The generators of the chains are seeded with seed, by default from rand(), so a run is replayed with the seed given
+// to srand()
+SeedSet simulatedAnnealing(LTGraph& G, double p, SeedSet& S, int maxIter, double T, double alpha, int chains = 1, int exchangeEvery = 100,
+                          size_t cacheSize = 0, uint64_t seed = rand()) {
+    int t;
+    BestRegister<SeedSet> best(S, simulateLT(G, p, S, t) / S.size());
+    vector<LTAnnealingChain> chain;
+    // The caches hold iterators into themselves, so the chains must not be copied once they are in use
+    chain.reserve(chains);
+    for (int k = 0; k < chains; ++k) {
+        chain.push_back(LTAnnealingChain(G, p, S, chainTemperature(T, alpha, maxIter, k, chains), alpha, seed, k, best, cacheSize));
+    }
+    Rng rng(seed, chains);
+    parallelTempering(chain, maxIter, exchangeEvery, rng);
+    FitnessCache stats;
+    for (const LTAnnealingChain& c : chain) stats.add(c.cache);
+    stats.capacity = cacheSize;
+    stats.printStats("Fitness cache");
+    return best.S;
 }
 
+#ifndef TSS_NO_MAIN
 int main() {
     
-    // Generate random seed for proper random values
-    unsigned seed = chrono::high_resolution_clock::now().time_since_epoch().count();
+    // Generate random seed for proper random values (set TSS_SEED to replay a run)
+    uint64_t seed = chooseSeed();
     srand(seed);
 
-    // Declare and read the graph G = (V, E)
-    Graph G = readGraph();
+    // Declare and read the graph G = (V, E) with the ids of the file. RCM lays neighbourhoods out contiguously in
+    // memory, but ties between nodes are broken on their ids, so it could change the seeds found
+    LTGraph G = readGraph(NATURAL);
 
     // Set the probability for the IC model
     double r = 0.5;
 
     auto start = high_resolution_clock::now();
     // Compute the subset with the greedy algorithm
-    Subset S = greedyMinInfluenceSet(G, r);
+    SeedSet S = greedyMinInfluenceSet(G, r);
     auto stop = high_resolution_clock::now();
     auto duration = duration_cast<milliseconds>(stop - start);
 
@@ -114,13 +134,19 @@ int main() {
     int maxIter = 15000;
     double T = 100;
     double alpha = 0.99;
+    // Number of chains of parallel tempering (1 for plain simulated annealing) and iterations between exchanges
+    int chains = 1;
+    int exchangeEvery = 100;
+    // Maximum number of seed sets whose evaluation is cached by every chain (0 to disable the cache)
+    size_t cacheSize = 1 << 16;
 
     // Improve the initial solution with Simulated Annealing
     auto start_SA = high_resolution_clock::now();
-    Subset improved_S = simulatedAnnealing(G, r, S, maxIter, T, alpha);
+    SeedSet improved_S = simulatedAnnealing(G, r, S, maxIter, T, alpha, chains, exchangeEvery, cacheSize);
     auto stop_SA = high_resolution_clock::now();
     auto duration_SA = duration_cast<milliseconds>(stop_SA - start_SA);
 
     // Simulated Annealing solution output
     cout << "Seed nodes selected by simulated annealing: " << improved_S.size() << " in " << (double)duration_SA.count()/1000 << " s" << endl;
-}
\ No newline at end of file
+}
+#endif
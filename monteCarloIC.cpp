@@ -0,0 +1,517 @@
+#ifndef MONTECARLOIC_CPP
+#define MONTECARLOIC_CPP
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <cstdint>
+#include <cmath>
+#include "graph.cpp"
+#include "parallel.cpp"
+#include "rng.cpp"
+#include "workspace.cpp"
+#include "seedSet.cpp"
+#include "cascadeLimit.cpp"
+#include "worldsIC.cpp"
+#include "indexedHeap.cpp"
+#include "componentsIC.cpp"
+using namespace std;
+typedef pair<int, int> pii;
+
+// Master seed of the Monte Carlo simulations and number of monteCarlo calls made so far
+// The calls are counted per thread: an algorithm takes its call numbers on the thread that runs it (the parallel
+// loops get theirs passed), so concurrent jobs (see batch.cpp) number their calls independently
+unsigned long long masterSeed = 0;
+thread_local unsigned long long numMonteCarloCalls = 0;
+
+void seedMonteCarlo(unsigned long long seed) {
+    masterSeed = seed;
+    numMonteCarloCalls = 0;
+}
+
+// Stream reserved for the random decisions of the search algorithms (e.g. moves of simulated annealing)
+const uint32_t searchStream = 0xFFFFFFFF;
+
+// Samplers of the IC simulations:
+// BIT_PARALLEL runs batches of 64 worlds with difusioICBitParallel when monteCarlo has at least bitParallelThreshold
+// simulations, and uses COIN_FLIP otherwise. COIN_FLIP draws one number per probed neighbour, while GEOMETRIC jumps
+// straight to the next successful edge of each adjacency list, drawing O(successes) numbers (best for low p)
+enum ICSampler { BIT_PARALLEL, COIN_FLIP, GEOMETRIC };
+ICSampler icSampler = BIT_PARALLEL;
+
+// Simulate IC difusion process, drawing the coin flips from rng (any generator with the interface of Philox)
+// The influenced nodes and the layers are kept in the workspace ws, so nothing is allocated or cleared
+// The cascade stops early as told by limit (see cascadeLimit.cpp), checked before every layer
+template <class RNG>
+int difusioIC(const Graph& G, double& p, const SeedSet& S, RNG& rng, SimulationWorkspace& ws,
+              const CascadeLimit& limit = CascadeLimit()) {
+    ws.begin(G.numNodes);
+
+    int n_influenced = 0;
+    
+    int t = 0;
+
+    double logq = log1p(-p);
+
+    // With a target, the influenced nodes of every component are counted to bound the ones still reachable
+    const GraphComponents* C = limit.target >= 0 ? &graphComponents(G) : nullptr;
+
+    // Activate initial set of nodes
+    for (int vertex : S) {
+        ws.visit(vertex);
+        ++n_influenced;
+        ws.frontier.push_back(vertex);
+        if (C != nullptr) ws.incrementComponent(C->comp[vertex]);
+    }
+
+    // Continue untill no more active nodes
+    while (not ws.frontier.empty()) {
+        if (limit.horizon >= 0 and t >= limit.horizon) break;
+        if (C != nullptr and (n_influenced >= limit.target or targetUnreachable(*C, ws, ws.frontier, n_influenced, limit.target))) break;
+        ++t;
+        // Process all active nodes in the current layer
+        for (int v : ws.frontier) {
+            // Check neighbours of v
+            if (icSampler == GEOMETRIC) {
+                // Every edge succeeds independently with probability p, so the gaps between successes are geometric.
+                // The coin of an already influenced neighbour would have been ignored, so skipping over it is the same
+                Neighbours neighbours = G.neighbours(v);
+                for (double j = geometricSkip(logq, rng); j < neighbours.size(); j += 1 + geometricSkip(logq, rng)) {
+                    int neighbour = neighbours[j];
+                    if (not ws.visited(neighbour)) {
+                        ws.visit(neighbour);
+                        ++n_influenced;
+                        ws.next.push_back(neighbour);
+                        if (C != nullptr) ws.incrementComponent(C->comp[neighbour]);
+                    }
+                }
+            }
+            else for (int neighbour : G.neighbours(v)) {
+                 // If neighbor is not already active, try to activate it
+                if (not ws.visited(neighbour)) {
+                    double r = rng.uniform();
+                    if (r < p) {
+                        ws.visit(neighbour);
+                        ++n_influenced;
+                        ws.next.push_back(neighbour);
+                        if (C != nullptr) ws.incrementComponent(C->comp[neighbour]);
+                    }
+                }
+            }
+        }
+        ws.advance();
+    }
+
+    return n_influenced;
+}
+
+// Simulate up to 64 independent IC diffusions at once: bit k of mask[v] tells whether v is influenced in world k
+// lanes has a bit set for every world to simulate. Each time v is reached in some worlds it tries to activate every
+// neighbour in all of them with a single bernoulliMask, so one sweep over the graph advances all the worlds
+// Returns the total number of influenced nodes over the worlds
+// The worlds stop early as told by limit, checked before every layer: a world that reaches the target of limit, or
+// can no longer reach it, is dropped from lanes (see LaneLimit), and the simulation ends once no world is left
+// If squares is given, the sum of the squares of the spreads of the worlds is added to it
+template <class RNG>
+long long difusioICBitParallel(const Graph& G, double p, const SeedSet& S, uint64_t lanes, RNG& rng, SimulationWorkspace& ws,
+                               const CascadeLimit& limit = CascadeLimit(), long long* squares = nullptr) {
+    uint64_t worlds = lanes;
+    // The masks stay at 0 between calls; only the touched vertices are cleared at the end
+    ws.resizeWorlds(G.numNodes);
+    ws.begin(G.numNodes);
+    vector<uint64_t>& influenced = ws.worlds;
+    vector<uint64_t>& frontier = ws.worldFrontier;
+    vector<uint64_t>& next = ws.worldNext;
+    vector<int>& touched = ws.touched;
+    touched.clear();
+    uint64_t prob = fixedPoint(p);
+
+    // Activate initial set of nodes in every world
+    for (int vertex : S) {
+        influenced[vertex] = lanes;
+        frontier[vertex] = lanes;
+        ws.frontier.push_back(vertex);
+        touched.push_back(vertex);
+    }
+
+    // With a target, the influenced nodes of every world are counted to tell when it is settled
+    LaneLimit* L = limit.target >= 0 ? &laneLimit() : nullptr;
+    if (L != nullptr) L->begin(graphComponents(G), S, lanes, limit.target);
+
+    // Continue untill no world has active nodes
+    for (int t = 0; not ws.frontier.empty(); ++t) {
+        if (L != nullptr) {
+            uint64_t decided = L->decided(ws.frontier, frontier, lanes);
+            if (decided != 0) {
+                lanes &= ~decided;
+                for (int v : ws.frontier) frontier[v] &= lanes;
+            }
+            if (lanes == 0) break;
+        }
+        if (limit.horizon >= 0 and t >= limit.horizon) {
+            for (int v : ws.frontier) frontier[v] = 0;
+            break;
+        }
+        for (int v : ws.frontier) {
+            uint64_t f = frontier[v];
+            frontier[v] = 0;
+            for (int neighbour : G.neighbours(v)) {
+                // Worlds where v is active and the neighbour is not influenced yet
+                uint64_t candidates = f & ~influenced[neighbour];
+                if (candidates == 0) continue;
+                uint64_t activated = bernoulliMask(prob, rng, candidates);
+                if (activated == 0) continue;
+                if (influenced[neighbour] == 0) touched.push_back(neighbour);
+                if (next[neighbour] == 0) ws.next.push_back(neighbour);
+                influenced[neighbour] |= activated;
+                next[neighbour] |= activated;
+                if (L != nullptr) L->influence(neighbour, activated);
+            }
+        }
+        for (int v : ws.next) {
+            frontier[v] = next[v];
+            next[v] = 0;
+        }
+        ws.advance();
+    }
+
+    // The spread of every world is counted from the masks, bit-sliced, only if asked for
+    LaneCounter spread;
+    if (squares != nullptr) spread.set(0, 0);
+    long long n_influenced = 0;
+    for (int v : touched) {
+        n_influenced += __builtin_popcountll(influenced[v]);
+        if (squares != nullptr) spread.add(influenced[v]);
+        influenced[v] = 0;
+    }
+    if (squares != nullptr) {
+        for (uint64_t l = worlds; l != 0; l &= l - 1) {
+            long long c = spread.get(__builtin_ctzll(l));
+            *squares += c * c;
+        }
+    }
+    return n_influenced;
+}
+
+// Minimum number of simulations for which monteCarlo uses the bit-parallel engine
+int bitParallelThreshold = 8;
+
+// Units of work of a monteCarlo evaluation with the given number of simulations: batches of 64 worlds (sampled or
+// pre-sampled live-edge worlds) or single simulations
+int monteCarloUnits(int iterations) {
+    if (icWorlds != nullptr) return icWorlds->batches();
+    if (icSampler == BIT_PARALLEL and iterations >= bitParallelThreshold) return (iterations + 63) / 64;
+    return iterations;
+}
+
+// Simulations in unit u of a monteCarlo evaluation: the last batch of 64 may be partial
+int unitSimulations(int iterations, int u) {
+    if (icWorlds != nullptr) return min(64, icWorlds->numWorlds - 64 * u);
+    if (icSampler == BIT_PARALLEL and iterations >= bitParallelThreshold) return min(64, iterations - 64 * u);
+    return 1;
+}
+
+// Total spread over the simulations of unit u of the monteCarlo call number call
+// The simulations stop early as told by limit (not the ones on the live-edge worlds). If squares is given, the sum of
+// the squares of their spreads is added to it (not on the live-edge worlds either)
+long long monteCarloUnit(const Graph& G, double p, const SeedSet& S, int iterations, unsigned long long call, int u,
+                         const CascadeLimit& limit = CascadeLimit(), long long* squares = nullptr) {
+    SimulationWorkspace& ws = threadWorkspace();
+    if (icWorlds != nullptr) return difusioICWorlds(G, *icWorlds, u, S, ws);
+    Rng rng(masterSeed, u, call);
+    if (icSampler == BIT_PARALLEL and iterations >= bitParallelThreshold) {
+        int worlds = min(64, iterations - 64 * u);
+        uint64_t lanes = worlds == 64 ? ~0ULL : (1ULL << worlds) - 1;
+        return difusioICBitParallel(G, p, S, lanes, rng, ws, limit, squares);
+    }
+    long long spread = difusioIC(G, p, S, rng, ws, limit);
+    if (squares != nullptr) *squares += spread * spread;
+    return spread;
+}
+
+// Simulate the IC model several times for more accuracy
+// The simulations run in parallel; simulation i of the c-th call draws from its own stream (i, c),
+// so the result only depends on the master seed and not on the number of threads
+// With enough simulations they are run in batches of 64 worlds by difusioICBitParallel, batch b using stream (b, c)
+// If live-edge worlds are in use (see useWorlds) S is evaluated on all of them, or on their components if they are
+// condensed (see useComponents), and iterations is ignored
+// Callers that run on several threads reserve their call numbers (a block of numMonteCarloCalls) and pass them
+// explicitly, so that the streams do not depend on the order in which the threads get to the counter
+int monteCarlo(const Graph& G, double p, const SeedSet& S, int iterations, unsigned long long call) {
+    if (icComponents != nullptr) return componentSpread(*icComponents, S);
+    atomic<long long> sum(0);
+    parallelFor(monteCarloUnits(iterations), [&](int u) {
+        sum += monteCarloUnit(G, p, S, iterations, call, u);
+    });
+    return sum / (icWorlds != nullptr ? icWorlds->numWorlds : iterations);
+}
+
+int monteCarlo(const Graph& G, double p, const SeedSet& S, int iterations) {
+    if (icComponents != nullptr) return componentSpread(*icComponents, S);
+    return monteCarlo(G, p, S, iterations, numMonteCarloCalls++);
+}
+
+// Result of monteCarloAtLeast: whether the spread reaches the threshold, the spread estimated from the simulations
+// that were run (a lower bound if cascades stopped early, the components' mass if none were run) and their number
+struct ThresholdTest {
+    bool reached;
+    int spread;
+    int simulations;
+};
+
+// Probability that a decision of monteCarloAtLeast taken by the confidence bounds is wrong (0 to stop early only when
+// the result of the full evaluation is already certain)
+double sequentialDelta = 0.05;
+
+// Worlds of the first batch of a sequential test with the bit-parallel engine and a threshold of n (see
+// monteCarloAtLeast). Smaller batches stop more tests early, but they take about as long as a batch of 64 when the
+// cascades of the few worlds touch most of the graph, so they only pay off with small cascades
+int sequentialFirstBatch = 64;
+
+// Calls of monteCarloAtLeast, simulations they ran and simulations the full evaluations would have run
+atomic<long long> sequentialCalls(0), sequentialSimulations(0), sequentialBudget(0);
+
+// Sequential test of monteCarlo(G, p, S, iterations, call) >= threshold: the simulations are run in waves that double
+// the ones done so far, and after every wave (a look) the simulation stops if the answer is settled:
+// - exactly, if the result of the full evaluation is already known whatever the remaining simulations give
+//   (between 0 and n nodes each), e.g. a single simulation that misses a node when the threshold is n
+// - if the threshold is out of the confidence interval of the mean spread, the tighter of the Hoeffding bound and
+//   the empirical Bernstein bound (Audibert et al. 2009), each with half of the confidence. Look k uses the
+//   confidence 1 - 6 sequentialDelta / (pi k)^2, so all the looks together are wrong with probability at most
+//   sequentialDelta. The Bernstein bound uses the empirical variance of the spreads of the single simulations, whose
+//   mean and sum of squared deviations are kept with Welford's method, merging every batch (Chan et al. 1979)
+// Otherwise it runs up to iterations simulations, the hard cap, and answers as a full evaluation would
+// The simulations are single cascades or batches of 64 worlds drawn from the streams of monteCarlo. With a threshold
+// of n, where a single world that misses a node settles the answer, the bit-parallel batches can be
+// sequentialFirstBatch, sequentialFirstBatch, 2 sequentialFirstBatch... worlds up to 64 instead, so that such an
+// answer does not wait for a whole batch (batch b draws from stream (b, call), so they are not the worlds of
+// monteCarlo). Below n the first looks can seldom decide
+// The waves do not depend on the threads, so the answer does not either
+// If the seeds' components hold less than threshold nodes the answer is no without simulating, and with a threshold
+// of n every cascade stops as soon as it can no longer influence the whole graph (its count is then below n, which
+// settles the answer all the same). A world of a bit-parallel batch stops on its own, so the worlds left draw other
+// coins than in monteCarlo, from the same distribution. With horizon >= 0 the cascades only run horizon time steps
+// (not on fixed worlds)
+ThresholdTest monteCarloAtLeast(const Graph& G, double p, const SeedSet& S, double threshold, int iterations,
+                                unsigned long long call, int horizon = -1) {
+    if (icComponents != nullptr or icWorlds != nullptr) {
+        // The worlds are fixed and a spread on them costs the same whatever the threshold
+        int spread = monteCarlo(G, p, S, iterations, call);
+        return {spread >= threshold, spread, 0};
+    }
+    int n = G.numNodes;
+    long long mass = componentMass(G, S);
+    if (mass < threshold) {
+        ++sequentialCalls;
+        sequentialBudget += iterations;
+        return {false, (int) mass, 0};
+    }
+    CascadeLimit limit(threshold >= n ? n : -1, horizon);
+    bool bitParallel = icSampler == BIT_PARALLEL and iterations >= bitParallelThreshold;
+    int firstBatch = threshold >= n ? sequentialFirstBatch : 64;
+    // Simulations of every batch
+    vector<int> size;
+    for (int done = 0; done < iterations; done += size.back()) {
+        size.push_back(bitParallel ? min(iterations - done, min(64, max(firstBatch, done))) : 1);
+    }
+    int batches = size.size();
+    vector<long long> value(batches), squares(batches);
+    long long sum = 0;
+    int simulations = 0;
+    // Mean and sum of squared deviations of the spreads of the simulations
+    double mean = 0, m2 = 0;
+    int looks = 0;
+    int decision = -1;
+    for (int done = 0; done < batches and decision == -1; ) {
+        int first = done;
+        int target = max(1, simulations);
+        for (int wave = 0; done < batches and wave < target; ++done) wave += size[done];
+        parallelFor(done - first, [&](int i) {
+            int b = first + i;
+            squares[b] = 0;
+            if (not bitParallel or firstBatch == 64) {
+                value[b] = monteCarloUnit(G, p, S, iterations, call, b, limit, &squares[b]);
+            }
+            else {
+                Rng rng(masterSeed, b, call);
+                uint64_t lanes = size[b] == 64 ? ~0ULL : (1ULL << size[b]) - 1;
+                value[b] = difusioICBitParallel(G, p, S, lanes, rng, threadWorkspace(), limit, &squares[b]);
+            }
+        });
+        for (int b = first; b < done; ++b) {
+            double batchMean = (double) value[b] / size[b];
+            double batchM2 = squares[b] - (double) value[b] * batchMean;
+            double d = batchMean - mean;
+            double total = simulations + size[b];
+            mean += d * size[b] / total;
+            m2 += batchM2 + d * d * simulations * size[b] / total;
+            sum += value[b];
+            simulations += size[b];
+        }
+        if (done == batches) break;
+
+        long long remaining = (long long) (iterations - simulations) * n;
+        if (sum / iterations >= threshold) decision = 1;
+        else if ((sum + remaining) / iterations < threshold) decision = 0;
+        else if (sequentialDelta > 0 and simulations >= 2) {
+            double variance = m2 / (simulations - 1);
+            ++looks;
+            double delta = sequentialDelta * 6 / (M_PI * M_PI * looks * looks);
+            double hoeffding = n * sqrt(log(4 / delta) / (2.0 * simulations));
+            double bernstein = sqrt(2 * variance * log(6 / delta) / simulations) + 3.0 * n * log(6 / delta) / simulations;
+            double epsilon = min(hoeffding, bernstein);
+            if (mean - epsilon >= threshold) decision = 1;
+            else if (mean + epsilon < threshold) decision = 0;
+        }
+    }
+    ++sequentialCalls;
+    sequentialSimulations += simulations;
+    sequentialBudget += iterations;
+    if (decision == -1) decision = sum / iterations >= threshold;
+    return {decision == 1, (int) (sum / simulations), simulations};
+}
+
+void printSequentialStats() {
+    if (sequentialCalls == 0) return;
+    long long saved = sequentialBudget - sequentialSimulations;
+    cerr << "Sequential tests: " << sequentialCalls << " calls, " << sequentialSimulations << " of " << sequentialBudget
+         << " simulations run (" << 100.0 * saved / sequentialBudget << "% saved, " << (double) saved / sequentialCalls
+         << " per call)" << endl;
+}
+
+// Spread of every single node, the first round of the greedy algorithm, equal to n calls monteCarlo({v}) in order
+// Every node is a task, except the hubs, whose estimated cost (degree times units of work) is large enough to
+// unbalance the threads, which are split into tasks of a few units. Tasks are taken from the pool one at a time, the most
+// expensive first, so idle threads keep picking up work until the end and the skew in degrees does not leave
+// them waiting for a single hub
+vector<int> singletonSpreads(const Graph& G, double p, int nMonteCarlo) {
+    int n = G.numNodes;
+    int units = monteCarloUnits(nMonteCarlo);
+    unsigned long long firstCall = numMonteCarloCalls;
+    numMonteCarloCalls += n;
+    // Node, first unit and last unit of every task
+    struct Task {
+        int node, first, last;
+    };
+    vector<Task> tasks;
+    double totalCost = 0;
+    for (int v = 0; v < n; ++v) totalCost += (G.degree(v) + 1.0) * units;
+    // A node is split when it alone would take more than 1/64 of the work of a thread
+    double taskCost = max(1.0, totalCost / (64.0 * threadPool().numThreads()));
+    for (int v = 0; v < n; ++v) {
+        int chunks = min<double>(units, ceil((G.degree(v) + 1.0) * units / taskCost));
+        int grain = (units + chunks - 1) / chunks;
+        for (int first = 0; first < units; first += grain) tasks.push_back({v, first, min(units, first + grain)});
+    }
+    stable_sort(tasks.begin(), tasks.end(), [&](const Task& a, const Task& b) {
+        return (G.degree(a.node) + 1.0) * (a.last - a.first) > (G.degree(b.node) + 1.0) * (b.last - b.first);
+    });
+
+    vector<atomic<long long> > sum(n);
+    for (auto& s : sum) s = 0;
+    ProgressCounter progress("Singleton spreads", tasks.size(), "tasks", "simulations");
+    parallelFor(tasks.size(), [&](int i) {
+        const Task& task = tasks[i];
+        thread_local SeedSet single_node_set;
+        single_node_set.clear();
+        single_node_set.insert(task.node);
+        long long s = 0, simulations = 0;
+        for (int u = task.first; u < task.last; ++u) {
+            s += monteCarloUnit(G, p, single_node_set, nMonteCarlo, firstCall + task.node, u);
+            simulations += unitSimulations(nMonteCarlo, u);
+        }
+        sum[task.node] += s;
+        progress.add(1, simulations);
+    });
+    progress.summary();
+
+    vector<int> spread(n);
+    int divisor = icWorlds != nullptr ? icWorlds->numWorlds : nMonteCarlo;
+    for (int v = 0; v < n; ++v) spread[v] = sum[v] / divisor;
+    return spread;
+}
+
+// Greedy algorithm to select the minimum influence set: CELF++ lazy forward selection (Goyal et al. 2011)
+// Every round adds the node with the largest marginal gain. Gains can only decrease as S grows, so stale gains are
+// upper bounds and only the node on top of the heap needs to be evaluated again. Along with the gain of u, CELF++
+// computes its gain with respect to S + {prevBest}, the best node of the round so far, which is reused if prevBest
+// is the next node added
+// The candidates are appended to S and erased right after their evaluation, so S keeps the order of the seeds
+SeedSet greedyMinInfluenceSet(const Graph& G, double p, int nMonteCarlo, double optimality) {
+    if (icComponents != nullptr) return componentMinInfluenceSet(*icComponents, optimality);
+    SeedSet S(G.numNodes);
+    int numNodes = G.numNodes;
+    IndexedHeap Q(numNodes);
+    // For every node u: round (size of S) when its gain was computed, gain w.r.t. S, spread of S + {u},
+    // prevBest and gain w.r.t. S + {prevBest}
+    vector<int> flag(numNodes, 0), prevBest(numNodes, -1);
+    vector<int> gain(numNodes), spreadWith(numNodes), gainWithBest(numNodes);
+    long long evaluations = 0, naiveEvaluations = 0;
+
+    // Calcular la ganancia marginal de todos los nodos e ir insertando en la cola de prioridad
+    vector<int> singleSpread = singletonSpreads(G, p, nMonteCarlo);
+    for (int i = 0; i < numNodes; ++i) {
+        spreadWith[i] = gain[i] = singleSpread[i];
+        Q.push(i, gain[i]);
+    }
+
+    int diffusion = 0;
+    int lastSeed = -1;
+    // Best node of the current round and spread of S + {curBest}
+    int curBest = -1;
+    int spreadWithBest = 0;
+
+    // Mientras la cola Q no esté vacía y difusio(G, p, S) != |V|
+    while (!Q.empty()) {
+        // If current difussion is OK, break
+        if (diffusion >= optimality * numNodes) break;
+
+        int u = Q.top();
+        int round = S.size();
+
+        // Añadir el primer nodo de la cola Q a S si su ganancia está actualizada
+        if (flag[u] == round) {
+            S.insert(u);
+            diffusion = spreadWith[u];
+            lastSeed = u;
+            curBest = -1;
+            naiveEvaluations += numNodes - S.size();
+            Q.pop();
+            continue;
+        }
+
+        if (prevBest[u] == lastSeed and flag[u] == round - 1) {
+            // The gain w.r.t. S + {lastSeed} was already computed in the previous round
+            gain[u] = gainWithBest[u];
+            spreadWith[u] = diffusion + gain[u];
+        }
+        else {
+            S.insert(u);
+            spreadWith[u] = monteCarlo(G, p, S, nMonteCarlo);
+            gain[u] = spreadWith[u] - diffusion;
+            prevBest[u] = curBest;
+            if (curBest != -1) {
+                S.insert(curBest);
+                gainWithBest[u] = monteCarlo(G, p, S, nMonteCarlo) - spreadWithBest;
+                S.erase(curBest);
+                ++evaluations;
+            }
+            S.erase(u);
+            ++evaluations;
+        }
+        flag[u] = round;
+        Q.update(u, gain[u]);
+        if (curBest == -1 or gain[u] > gain[curBest]) {
+            curBest = u;
+            spreadWithBest = spreadWith[u];
+        }
+    }
+
+    cerr << "CELF++: " << evaluations << " spread evaluations after the first round, " << naiveEvaluations - evaluations << " skipped" << endl;
+    return S;
+}
+
+#endif
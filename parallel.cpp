@@ -0,0 +1,161 @@
+#ifndef PARALLEL_CPP
+#define PARALLEL_CPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <chrono>
+using namespace std;
+
+// Persistent pool of worker threads, so that short parallel loops (e.g. one monteCarlo call) do not pay thread creation
+struct ThreadPool {
+    vector<thread> workers;
+    mutex m;
+    condition_variable wake, finished;
+    // Loop being executed: body(i) for i in [0, count)
+    const function<void(int)>* body;
+    int count;
+    atomic<int> next;
+    int running;
+    unsigned long long generation;
+    bool stop;
+    // Only one loop runs at a time
+    mutex loop;
+
+    ThreadPool(int numThreads) : body(nullptr), count(0), next(0), running(0), generation(0), stop(false) {
+        for (int i = 1; i < numThreads; ++i) workers.push_back(thread(&ThreadPool::work, this));
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(m);
+            stop = true;
+        }
+        wake.notify_all();
+        for (thread& w : workers) w.join();
+    }
+
+    int numThreads() const {
+        return workers.size() + 1;
+    }
+
+    // Run body(i) for every i in [0, n), taking indices one by one
+    void runIndices(const function<void(int)>& f, int n) {
+        for (int i = next++; i < n; i = next++) f(i);
+    }
+
+    void work() {
+        unsigned long long seen = 0;
+        insideWorker() = true;
+        while (true) {
+            const function<void(int)>* f;
+            int n;
+            {
+                unique_lock<mutex> lock(m);
+                wake.wait(lock, [&] { return stop or generation != seen; });
+                if (stop) return;
+                seen = generation;
+                // The loop may already be over if this worker woke up late
+                if (body == nullptr) continue;
+                f = body;
+                n = count;
+                ++running;
+            }
+            runIndices(*f, n);
+            {
+                lock_guard<mutex> lock(m);
+                if (--running == 0) finished.notify_all();
+            }
+        }
+    }
+
+    // Execute f(0), ..., f(n - 1) on all threads and wait for them to finish
+    // Calls made from inside a loop (nested parallelism) run serially on the calling thread
+    void parallelFor(int n, const function<void(int)>& f) {
+        if (n <= 1 or workers.empty() or insideWorker()) {
+            for (int i = 0; i < n; ++i) f(i);
+            return;
+        }
+        lock_guard<mutex> serial(loop);
+        {
+            lock_guard<mutex> lock(m);
+            body = &f;
+            count = n;
+            next = 0;
+            ++generation;
+        }
+        wake.notify_all();
+        insideWorker() = true;
+        runIndices(f, n);
+        insideWorker() = false;
+        unique_lock<mutex> lock(m);
+        finished.wait(lock, [&] { return running == 0; });
+        body = nullptr;
+    }
+
+    static bool& insideWorker() {
+        thread_local bool inside = false;
+        return inside;
+    }
+};
+
+// Number of threads to use: TSS_THREADS if it is set, otherwise all the cores
+int defaultNumThreads() {
+    const char* env = getenv("TSS_THREADS");
+    if (env != nullptr and atoi(env) > 0) return atoi(env);
+    return max(1u, thread::hardware_concurrency());
+}
+
+// Pool shared by the whole program
+ThreadPool& threadPool() {
+    static ThreadPool pool(defaultNumThreads());
+    return pool;
+}
+
+void parallelFor(int n, const function<void(int)>& f) {
+    threadPool().parallelFor(n, f);
+}
+
+// Progress of a long parallel phase: finished items and units of work, reported on the standard error every 10%
+// of the items once the phase has run for a second, and in a summary with the throughput at the end
+struct ProgressCounter {
+    string name, items, units;
+    long long total;
+    atomic<long long> done, work;
+    atomic<int> reported;
+    chrono::steady_clock::time_point start;
+
+    ProgressCounter(const string& name, long long total, const string& items, const string& units)
+        : name(name), items(items), units(units), total(total), done(0), work(0), reported(0), start(chrono::steady_clock::now()) {}
+
+    double seconds() const {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    // Called by any thread when it finishes some items and units of work
+    void add(long long finishedItems, long long finishedUnits) {
+        work += finishedUnits;
+        long long d = done += finishedItems;
+        int tenth = total > 0 ? 10 * d / total : 10;
+        int last = reported;
+        if (tenth > last and tenth < 10 and seconds() >= 1 and reported.compare_exchange_strong(last, tenth)) {
+            cerr << name << ": " << 10 * tenth << "% (" << d << "/" << total << " " << items << ", "
+                 << work / seconds() << " " << units << "/s)" << endl;
+        }
+    }
+
+    void summary() const {
+        double t = seconds();
+        cerr << name << ": " << done << " " << items << " and " << work << " " << units << " in " << t << " s ("
+             << done / t << " " << items << "/s, " << work / t << " " << units << "/s, " << threadPool().numThreads()
+             << " threads)" << endl;
+    }
+};
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef RNG_CPP
+#define RNG_CPP
+
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+using namespace std;
+
+// SplitMix64 mixing function, used to derive independent keys and seeds
+inline uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Seed of the run: TSS_SEED if it is set, otherwise the clock. It is printed so the run can be replayed
+uint64_t chooseSeed() {
+    const char* env = getenv("TSS_SEED");
+    uint64_t seed = env != nullptr ? strtoull(env, nullptr, 10) : chrono::high_resolution_clock::now().time_since_epoch().count();
+    cerr << "Seed: " << seed << endl;
+    return seed;
+}
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+// The i-th block of 4 numbers of stream (a, b) is Philox(counter = (i, a, b), key = seed), so any stream and
+// position can be reached directly and streams never overlap. Uniforms are produced in batches of
+// BATCH numbers computed lane by lane, a loop the compiler turns into SIMD code
+struct Philox {
+    static const int BLOCKS = 32;
+    static const int BATCH = 4 * BLOCKS;
+
+    uint32_t key[2];
+    uint32_t stream[2];
+    uint64_t block;
+    uint32_t buffer[BATCH];
+    int pos;
+
+    Philox(uint64_t seed = 0, uint64_t a = 0, uint64_t b = 0) {
+        uint64_t k = splitMix64(seed);
+        key[0] = k;
+        key[1] = k >> 32;
+        seek(a, b);
+    }
+
+    // Move to the beginning of stream (a, b); only the low 32 bits of a and b are used
+    void seek(uint64_t a, uint64_t b = 0) {
+        stream[0] = a;
+        stream[1] = b;
+        block = 0;
+        pos = BATCH;
+    }
+
+    // Compute the next BATCH words of the stream
+    void refill() {
+        uint32_t x0[BLOCKS], x1[BLOCKS], x2[BLOCKS], x3[BLOCKS];
+        for (int j = 0; j < BLOCKS; ++j) {
+            uint64_t c = block + j;
+            x0[j] = c;
+            x1[j] = c >> 32;
+            x2[j] = stream[0];
+            x3[j] = stream[1];
+        }
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; ++round) {
+            for (int j = 0; j < BLOCKS; ++j) {
+                uint64_t p0 = (uint64_t) 0xD2511F53 * x0[j];
+                uint64_t p1 = (uint64_t) 0xCD9E8D57 * x2[j];
+                uint32_t y0 = (p1 >> 32) ^ x1[j] ^ k0;
+                uint32_t y1 = p1;
+                uint32_t y2 = (p0 >> 32) ^ x3[j] ^ k1;
+                uint32_t y3 = p0;
+                x0[j] = y0;
+                x1[j] = y1;
+                x2[j] = y2;
+                x3[j] = y3;
+            }
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+        for (int j = 0; j < BLOCKS; ++j) {
+            buffer[4 * j] = x0[j];
+            buffer[4 * j + 1] = x1[j];
+            buffer[4 * j + 2] = x2[j];
+            buffer[4 * j + 3] = x3[j];
+        }
+        block += BLOCKS;
+        pos = 0;
+    }
+
+    inline uint32_t next32() {
+        if (pos == BATCH) refill();
+        return buffer[pos++];
+    }
+
+    inline uint64_t next64() {
+        uint64_t low = next32();
+        return low | (uint64_t) next32() << 32;
+    }
+
+    // Uniform double in [0, 1) with 32 bits of resolution
+    inline double uniform() {
+        return next32() * (1.0 / 4294967296.0);
+    }
+
+    // Uniform integer in [0, n)
+    inline int below(int n) {
+        return uniform() * n;
+    }
+};
+
+// Mersenne Twister behind the same interface, seeded from the stream, kept as a reference generator
+struct MersenneTwister {
+    uint64_t seed;
+    mt19937_64 engine;
+
+    MersenneTwister(uint64_t seed = 0, uint64_t a = 0, uint64_t b = 0) : seed(seed) {
+        seek(a, b);
+    }
+
+    void seek(uint64_t a, uint64_t b = 0) {
+        engine.seed(splitMix64(splitMix64(seed ^ splitMix64(b)) + a));
+    }
+
+    inline uint32_t next32() {
+        return engine() >> 32;
+    }
+
+    inline uint64_t next64() {
+        return engine();
+    }
+
+    inline double uniform() {
+        return (engine() >> 11) * 0x1.0p-53;
+    }
+
+    inline int below(int n) {
+        return uniform() * n;
+    }
+};
+
+// Probability p as a 32-bit fixed point number, for bernoulliMask()
+inline uint64_t fixedPoint(double p) {
+    if (p <= 0) return 0;
+    if (p >= 1) return 1ULL << 32;
+    return p * 4294967296.0;
+}
+
+// Independent coin flips for the bits of within: every one of them is 1 with probability p (given by fixedPoint)
+// Bit k compares a uniform U_k, built one binary digit at a time, with the binary expansion of p:
+// the digits are drawn for all 64 bits at once and the loop ends as soon as every comparison is decided
+// (after a single word when p = 0.5, and sooner the fewer bits within has)
+template <class RNG>
+inline uint64_t bernoulliMask(uint64_t p, RNG& rng, uint64_t within = ~0ULL) {
+    if (p == 0) return 0;
+    if (p >> 32) return within;
+    uint64_t result = 0, undecided = within;
+    int last = __builtin_ctzll(p);
+    for (int j = 31; j >= last and undecided; --j) {
+        uint64_t u = rng.next64();
+        if (p >> j & 1) {
+            result |= undecided & ~u;
+            undecided &= u;
+        }
+        else undecided &= ~u;
+    }
+    return result;
+}
+
+// Number of failures before the first success in a sequence of coin flips that succeed with probability p,
+// given logq = log(1 - p). Uses a single uniform whatever the result
+template <class RNG>
+inline double geometricSkip(double logq, RNG& rng) {
+    if (logq == 0) return INFINITY;
+    return floor(log(1 - rng.uniform()) / logq);
+}
+
+// Generator used by the simulations
+typedef Philox Rng;
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef RRSETSIC_CPP
+#define RRSETSIC_CPP
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <cmath>
+#include "monteCarloIC.cpp"
+using namespace std;
+
+// Reverse influence sampling (Borgs et al., Tang et al. "IMM") for the IC model
+// A reverse reachable (RR) set is the set of nodes that reach a uniformly random root in a sampled live-edge graph,
+// so the spread of S is numNodes * P(S intersects a random RR set)
+
+// Pool of RR sets stored back to back: set i is nodes[start[i]] ... nodes[start[i+1] - 1]
+// Once built, the inverted index lists the sets containing every node: setIds[nodeStart[v]] ... setIds[nodeStart[v+1] - 1]
+struct RRSets {
+    vector<int> nodes;
+    vector<long long> start;
+    vector<long long> nodeStart;
+    vector<int> setIds;
+
+    RRSets() : start(1, 0) {}
+
+    int count() const {
+        return start.size() - 1;
+    }
+
+    void append(const vector<int>& setNodes, const vector<long long>& setStart) {
+        long long base = nodes.size();
+        nodes.insert(nodes.end(), setNodes.begin(), setNodes.end());
+        for (size_t i = 1; i < setStart.size(); ++i) start.push_back(base + setStart[i]);
+    }
+
+    void buildIndex(int numNodes) {
+        nodeStart.assign(numNodes + 1, 0);
+        for (int v : nodes) ++nodeStart[v + 1];
+        for (int v = 0; v < numNodes; ++v) nodeStart[v + 1] += nodeStart[v];
+        setIds.resize(nodes.size());
+        vector<long long> pos(nodeStart.begin(), nodeStart.end() - 1);
+        for (int i = 0; i < count(); ++i) {
+            for (long long j = start[i]; j < start[i + 1]; ++j) setIds[pos[nodes[j]]++] = i;
+        }
+    }
+};
+
+// Sample one RR set rooted at a random node, appending its nodes to out
+// The visit marks of the workspace are epoch stamps, so they do not need to be cleared between sets
+template <class RNG>
+void sampleRRSet(const Graph& G, double p, RNG& rng, vector<int>& out, SimulationWorkspace& ws) {
+    double logq = log1p(-p);
+    size_t head = out.size();
+    ws.begin(G.numNodes);
+    int root = rng.below(G.numNodes);
+    ws.visit(root);
+    out.push_back(root);
+    // The graph is undirected, so the reverse BFS follows the same edges as a cascade
+    while (head < out.size()) {
+        int v = out[head++];
+        Neighbours neighbours = G.neighbours(v);
+        if (icSampler == GEOMETRIC) {
+            for (double j = geometricSkip(logq, rng); j < neighbours.size(); j += 1 + geometricSkip(logq, rng)) {
+                int neighbour = neighbours[j];
+                if (not ws.visited(neighbour)) {
+                    ws.visit(neighbour);
+                    out.push_back(neighbour);
+                }
+            }
+        }
+        else for (int neighbour : neighbours) {
+            if (not ws.visited(neighbour) and rng.uniform() < p) {
+                ws.visit(neighbour);
+                out.push_back(neighbour);
+            }
+        }
+    }
+}
+
+// Add RR sets to R until it has target sets
+// They are sampled in parallel in blocks of 256; block b of the c-th round uses stream (b, c), and blocks are
+// appended in order, so R only depends on the master seed
+void sampleRRSets(const Graph& G, double p, int target, RRSets& R) {
+    const int blockSize = 256;
+    int missing = target - R.count();
+    if (missing <= 0) return;
+    unsigned long long call = numMonteCarloCalls++;
+    int blocks = (missing + blockSize - 1) / blockSize;
+    vector<vector<int> > blockNodes(blocks);
+    vector<vector<long long> > blockStart(blocks);
+    parallelFor(blocks, [&](int b) {
+        SimulationWorkspace& ws = threadWorkspace();
+        Rng rng(masterSeed, b, call);
+        int sets = min(blockSize, missing - b * blockSize);
+        blockStart[b].push_back(0);
+        for (int i = 0; i < sets; ++i) {
+            sampleRRSet(G, p, rng, blockNodes[b], ws);
+            blockStart[b].push_back(blockNodes[b].size());
+        }
+    });
+    for (int b = 0; b < blocks; ++b) R.append(blockNodes[b], blockStart[b]);
+}
+
+// Greedy set cover over the RR sets: add the node covering most uncovered sets until a fraction optimality is covered
+SeedSet coverRRSets(const Graph& G, RRSets& R, double optimality) {
+    R.buildIndex(G.numNodes);
+    SeedSet S(G.numNodes);
+    vector<int> gain(G.numNodes);
+    priority_queue<pair<int, int> > Q;
+    for (int v = 0; v < G.numNodes; ++v) {
+        gain[v] = R.nodeStart[v + 1] - R.nodeStart[v];
+        Q.push(make_pair(gain[v], v));
+    }
+    vector<bool> covered(R.count(), false);
+    long long numCovered = 0;
+    double target = optimality * R.count();
+    while (numCovered < target and not Q.empty()) {
+        // Gains only decrease, so an entry whose gain is still current is the best node
+        int v = Q.top().second;
+        int g = Q.top().first;
+        Q.pop();
+        if (g != gain[v]) {
+            Q.push(make_pair(gain[v], v));
+            continue;
+        }
+        if (g == 0) break;
+        S.insert(v);
+        for (long long j = R.nodeStart[v]; j < R.nodeStart[v + 1]; ++j) {
+            int i = R.setIds[j];
+            if (covered[i]) continue;
+            covered[i] = true;
+            ++numCovered;
+            for (long long k = R.start[i]; k < R.start[i + 1]; ++k) --gain[R.nodes[k]];
+        }
+    }
+    return S;
+}
+
+// Number of RR sets needed so that, with probability 1 - 1/n^ell, every seed set of size k whose estimated spread
+// reaches J = optimality * n has a true spread of at least (1 - epsilon) J (martingale bound of IMM, union bound
+// over the C(n, k) sets of size k)
+double requiredRRSets(int n, int k, double optimality, double epsilon, double ell) {
+    double logBinomial = lgamma(n + 1.0) - lgamma(k + 1.0) - lgamma(n - k + 1.0);
+    double lambda = (2 + 2 * epsilon / 3) * (logBinomial + ell * log(n) + log(2.0)) * n / (epsilon * epsilon);
+    return lambda / (optimality * n);
+}
+
+// Maximum number of nodes stored over all the RR sets (1 GB)
+long long maxRRNodes = 1LL << 28;
+
+// Minimum influence set through reverse influence sampling: the smallest greedy cover of the RR sets whose estimated
+// spread reaches optimality * numNodes. The number of sets grows with the size k of the cover found, until it
+// satisfies requiredRRSets(k); the greedy cover is within a logarithmic factor of the smallest one
+SeedSet rrMinInfluenceSet(const Graph& G, double p, double optimality, double epsilon = 0.1, double ell = 1) {
+    int n = G.numNodes;
+    RRSets R;
+    SeedSet S(n);
+    int k = 1;
+    while (true) {
+        double theta = ceil(requiredRRSets(n, k, optimality, epsilon, ell));
+        if (R.count() >= theta) break;
+        if (R.nodes.size() >= 0.9 * maxRRNodes) {
+            cerr << "RR sets: memory limit reached with " << R.count() << " of " << theta << " sets, the guarantee does not hold" << endl;
+            break;
+        }
+        // Start with a small batch to learn the average size, then estimate how many more sets fit in memory
+        if (R.count() == 0) theta = min(theta, 1024.0);
+        double average = R.count() > 0 ? (double) R.nodes.size() / R.count() : 1;
+        theta = min(theta, R.count() + max(1.0, (maxRRNodes - (double) R.nodes.size()) / average));
+        sampleRRSets(G, p, min(theta, 2e9), R);
+        S = coverRRSets(G, R, optimality);
+        k = max<int>(1, S.size());
+    }
+    cerr << "RR sets: " << R.count() << " sets of " << (double) R.nodes.size() / R.count() << " nodes on average" << endl;
+    return S;
+}
+
+#endif
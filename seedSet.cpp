@@ -0,0 +1,78 @@
+#ifndef SEEDSET_CPP
+#define SEEDSET_CPP
+
+#include <vector>
+using namespace std;
+
+// Seed set of the search algorithms: the seeds in a flat array, iterated as a vector, and the position of every node
+// in that array (-1 if it is not a seed), a dense map over the nodes that answers membership in O(1)
+// Removing a seed moves the last one to its place (swap-remove), so insertions and removals are O(1) too. The order of
+// the seeds is the insertion order up to those moves, and an undo restores it exactly: insert(v) is undone by erase(v),
+// and erase(v) by restore(v, i) with the position i that erase returned. Searches change a set in place and undo the
+// move instead of copying it, since a copy costs O(n) for the positions
+struct SeedSet {
+    vector<int> nodes;
+    vector<int> position;
+
+    SeedSet(int n = 0) : position(n, -1) {}
+
+    size_t size() const {
+        return nodes.size();
+    }
+
+    bool empty() const {
+        return nodes.empty();
+    }
+
+    vector<int>::const_iterator begin() const {
+        return nodes.begin();
+    }
+
+    vector<int>::const_iterator end() const {
+        return nodes.end();
+    }
+
+    int operator[](int i) const {
+        return nodes[i];
+    }
+
+    bool contains(int v) const {
+        return v < (int) position.size() and position[v] != -1;
+    }
+
+    // Add v at the end, if it is not a seed yet (the positions grow as needed)
+    void insert(int v) {
+        if (v >= (int) position.size()) position.resize(v + 1, -1);
+        if (position[v] != -1) return;
+        position[v] = nodes.size();
+        nodes.push_back(v);
+    }
+
+    // Remove v, moving the last seed to its place; returns the position v had, or -1 if it was not a seed
+    int erase(int v) {
+        if (not contains(v)) return -1;
+        int i = position[v];
+        int last = nodes.back();
+        nodes[i] = last;
+        position[last] = i;
+        nodes.pop_back();
+        position[v] = -1;
+        return i;
+    }
+
+    // Undo the last erase, which removed v from position i
+    void restore(int v, int i) {
+        int moved = nodes.size() > (size_t) i ? nodes[i] : v;
+        nodes.push_back(moved);
+        position[moved] = nodes.size() - 1;
+        nodes[i] = v;
+        position[v] = i;
+    }
+
+    void clear() {
+        for (int v : nodes) position[v] = -1;
+        nodes.clear();
+    }
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef TEMPERING_CPP
+#define TEMPERING_CPP
+
+#include <vector>
+#include <mutex>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include "parallel.cpp"
+#include "rng.cpp"
+using namespace std;
+
+// Best solution found so far by any of the chains of a parallel tempering run, shared by all of them
+// A solution replaces the current one if its gain is larger, or equal and found by a chain with a smaller index,
+// so the result does not depend on the timing of the threads
+template <class Solution>
+struct BestRegister {
+    mutex m;
+    Solution S;
+    double gain;
+    int chain;
+
+    BestRegister(const Solution& S, double gain) : S(S), gain(gain), chain(-1) {}
+
+    void offer(const Solution& candidate, double g, int k) {
+        lock_guard<mutex> lock(m);
+        if (g > gain or (g == gain and chain != -1 and k < chain)) {
+            S = candidate;
+            gain = g;
+            chain = k;
+        }
+    }
+};
+
+// Initial temperature of chain k of K: the chains split geometrically the range of temperatures that a single chain
+// would go through, from T down to T * alpha^maxIter
+double chainTemperature(double T, double alpha, int maxIter, int k, int K) {
+    return T * pow(alpha, (double) maxIter * k / K);
+}
+
+// Parallel tempering (replica exchange Monte Carlo): the chains run maxIter iterations each, on all the threads,
+// each one at its own temperature. Every exchangeEvery iterations the chains are sorted by temperature and neighbours
+// swap temperatures with the Metropolis probability min(1, exp((g_hot - g_cold) (1/T_cold - 1/T_hot))), so good
+// solutions move down to the cold chains and the ones stuck in a local optimum are heated up
+// Chain needs gain (of its current solution), T and step(), one iteration of simulated annealing including the cooling
+// The exchanges draw from rng, and every chain from its own generator, so the run is the same with any number of threads
+template <class Chain>
+void parallelTempering(vector<Chain>& chains, int maxIter, int exchangeEvery, Rng& rng) {
+    int K = chains.size();
+    for (int done = 0; done < maxIter; done += exchangeEvery) {
+        int steps = min(exchangeEvery, maxIter - done);
+        parallelFor(K, [&](int k) {
+            for (int i = 0; i < steps; ++i) chains[k].step();
+        });
+        vector<int> order(K);
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return chains[a].T > chains[b].T; });
+        for (int i = 0; i + 1 < K; ++i) {
+            Chain& hot = chains[order[i]];
+            Chain& cold = chains[order[i + 1]];
+            if (hot.T <= 0 or cold.T <= 0) continue;
+            double x = (hot.gain - cold.gain) * (1 / cold.T - 1 / hot.T);
+            if (x >= 0 or rng.uniform() < exp(x)) {
+                swap(hot.T, cold.T);
+                swap(order[i], order[i + 1]);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef WORKSPACE_CPP
+#define WORKSPACE_CPP
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+// Scratch memory of the diffusion kernels, reused by every simulation run on the same thread
+// Visit marks and counters are stamped with the epoch of the simulation that wrote them, so starting a new
+// simulation only increments the epoch instead of clearing O(n) arrays, and a cascade costs only the vertices it
+// touches. The frontiers of consecutive layers are two flat arrays that are swapped, keeping their capacity
+struct SimulationWorkspace {
+    unsigned epoch;
+    // mark[v] == epoch iff v was visited (influenced) in the current simulation
+    vector<unsigned> mark;
+    // Counter of every node (the weight of the LT model): the epoch in the high half and the count in the low half,
+    // so a counter of an older simulation reads as 0 and an increment is a single word update that can be atomic
+    vector<uint64_t> counter;
+    // Number of influenced nodes of every connected component, stamped as counter, for the cascades with a target
+    // (see cascadeLimit.cpp)
+    vector<uint64_t> componentCounter;
+    // Nodes of the current layer and of the next one
+    vector<int> frontier, next;
+    // Worlds of the bit-parallel IC kernel, kept at 0 between simulations (only the touched nodes are cleared)
+    vector<uint64_t> worlds, worldFrontier, worldNext;
+    vector<int> touched;
+
+    SimulationWorkspace(int n = 0) : epoch(0) {
+        resize(n);
+    }
+
+    void resize(int n) {
+        if ((int) mark.size() >= n) return;
+        mark.assign(n, 0);
+        counter.assign(n, 0);
+        componentCounter.assign(n, 0);
+        frontier.reserve(n);
+        next.reserve(n);
+        epoch = 0;
+    }
+
+    // Start a new simulation on a graph of n nodes: no node is visited and every counter is 0
+    void begin(int n) {
+        resize(n);
+        if (++epoch == 0) {
+            fill(mark.begin(), mark.end(), 0);
+            fill(counter.begin(), counter.end(), 0);
+            fill(componentCounter.begin(), componentCounter.end(), 0);
+            epoch = 1;
+        }
+        frontier.clear();
+        next.clear();
+    }
+
+    bool visited(int v) const {
+        return mark[v] == epoch;
+    }
+
+    void visit(int v) {
+        mark[v] = epoch;
+    }
+
+    void unvisit(int v) {
+        mark[v] = 0;
+    }
+
+    int count(int v) const {
+        uint64_t c = counter[v];
+        return c >> 32 == epoch ? (uint32_t) c : 0;
+    }
+
+    static uint64_t incremented(uint64_t c, unsigned epoch) {
+        return c >> 32 == epoch ? c + 1 : (uint64_t) epoch << 32 | 1;
+    }
+
+    // Increment the counter of v and return its new value
+    int increment(int v) {
+        counter[v] = incremented(counter[v], epoch);
+        return (uint32_t) counter[v];
+    }
+
+    // Same as increment, safe when other threads increment counters at the same time
+    int incrementAtomic(int v) {
+        uint64_t c = __atomic_load_n(&counter[v], __ATOMIC_RELAXED);
+        uint64_t d;
+        do d = incremented(c, epoch);
+        while (not __atomic_compare_exchange_n(&counter[v], &c, d, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+        return (uint32_t) d;
+    }
+
+    // Set the counter of v to c
+    void setCount(int v, int c) {
+        counter[v] = (uint64_t) epoch << 32 | (uint32_t) c;
+    }
+
+    // Undo an increment of the current simulation
+    void decrement(int v) {
+        --counter[v];
+    }
+
+    int componentCount(int c) const {
+        uint64_t x = componentCounter[c];
+        return x >> 32 == epoch ? (uint32_t) x : 0;
+    }
+
+    void incrementComponent(int c) {
+        componentCounter[c] = incremented(componentCounter[c], epoch);
+    }
+
+    void decrementComponent(int c) {
+        --componentCounter[c];
+    }
+
+    // Move to the next layer: next becomes the frontier and is emptied
+    void advance() {
+        swap(frontier, next);
+        next.clear();
+    }
+
+    void resizeWorlds(int n) {
+        if ((int) worlds.size() >= n) return;
+        worlds.assign(n, 0);
+        worldFrontier.assign(n, 0);
+        worldNext.assign(n, 0);
+    }
+};
+
+// Workspace of the calling thread
+SimulationWorkspace& threadWorkspace() {
+    thread_local SimulationWorkspace workspace;
+    return workspace;
+}
+
+#endif
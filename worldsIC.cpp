@@ -0,0 +1,247 @@
+#ifndef WORLDSIC_CPP
+#define WORLDSIC_CPP
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#include "graph.cpp"
+#include "parallel.cpp"
+#include "rng.cpp"
+#include "workspace.cpp"
+#include "seedSet.cpp"
+using namespace std;
+
+// Live-edge worlds of the IC model: a cascade only crosses the live arcs of a sampled graph where every arc is live
+// with probability p, so the spread of S is the average number of nodes reachable from S over the worlds.
+// Sampling R worlds once and evaluating every seed set on them (common random numbers) makes the comparisons between
+// close seed sets much less noisy, costs no random numbers per evaluation and turns the spread into a deterministic
+// submodular function, for which the lazy greedy is exact
+// The graph is undirected and a cascade only tries an edge once, from the first of its ends to be influenced, so one
+// coin per edge gives the same distribution of the influenced set as one coin per arc: both arcs of an edge are live
+// or not together, and the worlds are undirected graphs (see componentsIC.cpp)
+// The worlds are stored in batches of 64 as bitsets over the arcs of the CSR: bit k of live[b * arcs + e] tells
+// whether arc e (the position in G.adj) is live in world 64 b + k
+struct LiveEdgeWorlds {
+    int numWorlds;
+    long long arcs;
+    double p;
+    uint64_t seed;
+    vector<uint64_t> live;
+
+    LiveEdgeWorlds() : numWorlds(0), arcs(0), p(0), seed(0) {}
+
+    int batches() const {
+        return (numWorlds + 63) / 64;
+    }
+
+    // Worlds of batch b
+    uint64_t lanes(int b) const {
+        int worlds = min(64, numWorlds - 64 * b);
+        return worlds == 64 ? ~0ULL : (1ULL << worlds) - 1;
+    }
+
+    const uint64_t* batch(int b) const {
+        return live.data() + b * arcs;
+    }
+};
+
+// Stream of the coins of the live-edge worlds, apart from the ones of monteCarlo and of the search algorithms
+const uint32_t worldStream = 0xFFFFFFFE;
+
+// Position of the opposite arc of every arc: if e is the k-th arc from v to u, reverse[e] is the k-th arc from u to v
+// Arcs are bucketed by target in increasing order of source, and then by source in increasing order of target, so
+// the outgoing arcs of v and its incoming arcs end up sorted by the other end, and match one by one
+vector<int> reverseArcs(const Graph& G) {
+    int n = G.numNodes;
+    int arcs = G.offset[n];
+    vector<int> incoming(arcs), outgoing(arcs), reverse(arcs), pos(G.offset, G.offset + n);
+    // incoming[G.offset[u] ...] lists the arcs into u by increasing source
+    for (int v = 0; v < n; ++v) {
+        for (int e = G.offset[v]; e < G.offset[v + 1]; ++e) incoming[pos[G.adj[e]]++] = e;
+    }
+    // outgoing[G.offset[v] ...] lists the arcs out of v by increasing target
+    copy(G.offset, G.offset + n, pos.begin());
+    vector<int> source(arcs);
+    for (int v = 0; v < n; ++v) {
+        for (int e = G.offset[v]; e < G.offset[v + 1]; ++e) source[e] = v;
+    }
+    for (int i = 0; i < arcs; ++i) outgoing[pos[source[incoming[i]]]++] = incoming[i];
+    for (int i = 0; i < arcs; ++i) reverse[outgoing[i]] = incoming[i];
+    return reverse;
+}
+
+// Sample R worlds for the probability p; batch b uses the stream (b, worldStream) of seed
+void sampleWorlds(const Graph& G, double p, int R, uint64_t seed, LiveEdgeWorlds& W) {
+    W.numWorlds = R;
+    W.arcs = G.offset[G.numNodes];
+    W.p = p;
+    W.seed = seed;
+    W.live.assign(W.batches() * W.arcs, 0);
+    uint64_t prob = fixedPoint(p);
+    vector<int> reverse = reverseArcs(G);
+    parallelFor(W.batches(), [&](int b) {
+        Rng rng(seed, b, worldStream);
+        uint64_t lanes = W.lanes(b);
+        uint64_t* live = W.live.data() + b * W.arcs;
+        // One coin per edge, flipped for its arc from the smaller end
+        for (int v = 0; v < G.numNodes; ++v) {
+            for (int e = G.offset[v]; e < G.offset[v + 1]; ++e) {
+                if (G.adj[e] >= v) live[e] = bernoulliMask(prob, rng, lanes);
+            }
+        }
+        for (int v = 0; v < G.numNodes; ++v) {
+            for (int e = G.offset[v]; e < G.offset[v + 1]; ++e) {
+                if (G.adj[e] < v) live[e] = live[reverse[e]];
+            }
+        }
+    });
+}
+
+// Total number of nodes reached from S over the 64 worlds of batch b, with the bit-parallel sweep of
+// difusioICBitParallel where the coin flips are replaced by the live arcs
+long long difusioICWorlds(const Graph& G, const LiveEdgeWorlds& W, int b, const SeedSet& S, SimulationWorkspace& ws) {
+    ws.resizeWorlds(G.numNodes);
+    ws.begin(G.numNodes);
+    vector<uint64_t>& influenced = ws.worlds;
+    vector<uint64_t>& frontier = ws.worldFrontier;
+    vector<uint64_t>& next = ws.worldNext;
+    vector<int>& touched = ws.touched;
+    touched.clear();
+    const uint64_t* live = W.batch(b);
+    uint64_t lanes = W.lanes(b);
+
+    for (int vertex : S) {
+        influenced[vertex] = lanes;
+        frontier[vertex] = lanes;
+        ws.frontier.push_back(vertex);
+        touched.push_back(vertex);
+    }
+
+    while (not ws.frontier.empty()) {
+        for (int v : ws.frontier) {
+            uint64_t f = frontier[v];
+            frontier[v] = 0;
+            for (int e = G.offset[v]; e < G.offset[v + 1]; ++e) {
+                int neighbour = G.adj[e];
+                // Worlds where v is active, the arc is live and the neighbour is not influenced yet
+                uint64_t activated = f & live[e] & ~influenced[neighbour];
+                if (activated == 0) continue;
+                if (influenced[neighbour] == 0) touched.push_back(neighbour);
+                if (next[neighbour] == 0) ws.next.push_back(neighbour);
+                influenced[neighbour] |= activated;
+                next[neighbour] |= activated;
+            }
+        }
+        for (int v : ws.next) {
+            frontier[v] = next[v];
+            next[v] = 0;
+        }
+        ws.advance();
+    }
+
+    long long n_influenced = 0;
+    for (int v : touched) {
+        n_influenced += __builtin_popcountll(influenced[v]);
+        influenced[v] = 0;
+    }
+    return n_influenced;
+}
+
+// Average spread of S over all the worlds, with the batches evaluated in parallel
+int worldsSpread(const Graph& G, const LiveEdgeWorlds& W, const SeedSet& S) {
+    atomic<long long> sum(0);
+    parallelFor(W.batches(), [&](int b) {
+        sum += difusioICWorlds(G, W, b, S, threadWorkspace());
+    });
+    return sum / W.numWorlds;
+}
+
+// File layout: WorldsHeader followed by the live array. The worlds are only valid for the same graph (same
+// checksum of its CSR arrays, so also the same vertex order), probability, number of worlds and seed
+const char worldsMagic[8] = {'T', 'S', 'S', 'W', 'L', 'D', 0, 0};
+const uint32_t worldsVersion = 2;
+
+struct WorldsHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numWorlds;
+    uint64_t numNodes;
+    uint64_t arcs;
+    double p;
+    uint64_t seed;
+    uint64_t graphChecksum;
+    uint64_t checksum;
+};
+
+uint64_t graphChecksum(const Graph& G) {
+    uint64_t h = checksum(G.offset, (G.numNodes + 1) * sizeof(int));
+    return checksum(G.adj, G.offset[G.numNodes] * sizeof(int), h);
+}
+
+bool loadWorlds(const string& path, const Graph& G, double p, int R, uint64_t seed, LiveEdgeWorlds& W) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (in == nullptr) return false;
+    WorldsHeader h;
+    bool ok = fread(&h, sizeof(h), 1, in) == 1 and memcmp(h.magic, worldsMagic, 8) == 0
+        and h.version == worldsVersion and h.numWorlds == (uint32_t) R and h.numNodes == (uint64_t) G.numNodes
+        and h.arcs == (uint64_t) G.offset[G.numNodes] and h.p == p and h.seed == seed
+        and h.graphChecksum == graphChecksum(G);
+    if (ok) {
+        W.numWorlds = R;
+        W.arcs = h.arcs;
+        W.p = p;
+        W.seed = seed;
+        W.live.resize(W.batches() * W.arcs);
+        ok = fread(W.live.data(), sizeof(uint64_t), W.live.size(), in) == W.live.size()
+            and checksum(W.live.data(), W.live.size() * sizeof(uint64_t)) == h.checksum;
+    }
+    fclose(in);
+    return ok;
+}
+
+// Written to a temporary file that is renamed at the end, so a crash never leaves a truncated file behind
+void writeWorlds(const string& path, const Graph& G, const LiveEdgeWorlds& W) {
+    WorldsHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, worldsMagic, 8);
+    h.version = worldsVersion;
+    h.numWorlds = W.numWorlds;
+    h.numNodes = G.numNodes;
+    h.arcs = W.arcs;
+    h.p = W.p;
+    h.seed = W.seed;
+    h.graphChecksum = graphChecksum(G);
+    h.checksum = checksum(W.live.data(), W.live.size() * sizeof(uint64_t));
+
+    string tmp = path + "." + to_string(getpid());
+    FILE* out = fopen(tmp.c_str(), "wb");
+    if (out == nullptr) return;
+    bool ok = fwrite(&h, sizeof(h), 1, out) == 1
+        and fwrite(W.live.data(), sizeof(uint64_t), W.live.size(), out) == W.live.size();
+    ok = fclose(out) == 0 and ok;
+    if (not ok or rename(tmp.c_str(), path.c_str()) != 0) unlink(tmp.c_str());
+}
+
+// Worlds used by monteCarlo instead of fresh simulations, if any
+const LiveEdgeWorlds* icWorlds = nullptr;
+
+// Make monteCarlo evaluate every seed set on R worlds of probability p, read from path if it holds the same worlds,
+// otherwise sampled and saved there (path may be empty to keep them only in memory)
+void useWorlds(const Graph& G, double p, int R, uint64_t seed, const string& path) {
+    static LiveEdgeWorlds worlds;
+    bool loaded = not path.empty() and loadWorlds(path, G, p, R, seed, worlds);
+    if (not loaded) {
+        sampleWorlds(G, p, R, seed, worlds);
+        if (not path.empty()) writeWorlds(path, G, worlds);
+    }
+    cerr << "Live-edge worlds: " << R << (loaded ? " loaded from " + path : " sampled") << " ("
+         << worlds.live.size() * sizeof(uint64_t) / 1e6 << " MB)" << endl;
+    icWorlds = &worlds;
+}
+
+#endif